@@ -8,6 +8,26 @@
 
 using namespace std;
 
+// Escapes backslashes and quotes for a JSON string value.
+static string escapeJson(const string& text) {
+    string out;
+    for (char c : text) {
+        if (c == '\\' || c == '"') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// Undoes escapeJson: a backslash keeps the character after it.
+static string unescapeJson(const string& text) {
+    string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\\' && i + 1 < text.size()) i++;
+        out += text[i];
+    }
+    return out;
+}
+
 // Creates an Auth manager and loads existing users from disk.
 Auth::Auth(const string& filepath) : usersFilePath(filepath) {
     loadUsers();
@@ -112,9 +132,37 @@ void Auth::loadUsers() {
             }
             user.macroRatio.fats = stod(fatsStr);
 
+            // Parse optional fiber, sugar, and sodium goals; older files
+            // without them keep the defaults.
+            getline(file, line);
+            while (line.find("Goal\"") != string::npos) {
+                start = line.find(":") + 1;
+                string goalStr = line.substr(start);
+                commaPos = goalStr.find(",");
+                if (commaPos != string::npos) {
+                    goalStr = goalStr.substr(0, commaPos);
+                }
+                if (line.find("\"fiberGoal\"") != string::npos) {
+                    user.fiberGoal = stod(goalStr);
+                } else if (line.find("\"sugarGoal\"") != string::npos) {
+                    user.sugarGoal = stod(goalStr);
+                } else if (line.find("\"sodiumGoal\"") != string::npos) {
+                    user.sodiumGoal = stod(goalStr);
+                }
+                getline(file, line);
+            }
+
+            // Parse optional diet filter.
+            if (line.find("\"dietFilter\"") != string::npos) {
+                start = line.find(":") + 1;
+                end = line.find_last_of("\"");
+                start = line.find("\"", start) + 1;
+                user.dietFilter = unescapeJson(line.substr(start, end - start));
+                getline(file, line);
+            }
+
             // Parse optional loggedMeals structure.
             user.loggedMeals.clear();
-            getline(file, line);
             if (line.find("loggedMeals") != string::npos) {
                 while (getline(file, line) && line.find("}") == string::npos) {
                     if (line.find("\"") != string::npos && line.find(":") != string::npos) {
@@ -177,6 +225,10 @@ void Auth::saveUsers() {
         file << "    \"proteinRatio\": " << fixed << setprecision(2) << user.macroRatio.protein << ",\n";
         file << "    \"carbsRatio\": " << user.macroRatio.carbs << ",\n";
         file << "    \"fatsRatio\": " << user.macroRatio.fats << ",\n";
+        file << "    \"fiberGoal\": " << user.fiberGoal << ",\n";
+        file << "    \"sugarGoal\": " << user.sugarGoal << ",\n";
+        file << "    \"sodiumGoal\": " << user.sodiumGoal << ",\n";
+        file << "    \"dietFilter\": \"" << escapeJson(user.dietFilter) << "\",\n";
         file << "    \"loggedMeals\": {\n";
 
         size_t dateIdx = 0;
@@ -274,3 +326,8 @@ User* Auth::findUserByUsername(const string& username) {
     }
     return nullptr;
 }
+
+// Returns every registered user.
+const vector<User>& Auth::getUsers() const {
+    return users;
+}
@@ -42,6 +42,9 @@ public:
 
     // Finds a user by username, or returns nullptr if not found.
     User* findUserByUsername(const std::string& username);
+
+    // Returns all registered users.
+    const std::vector<User>& getUsers() const;
 };
 
 #endif
@@ -0,0 +1,209 @@
+#include "BatchEvaluator.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_EVALUATOR_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Each kernel accumulates the residual of one candidate item by item, so
+// all three produce the same objectives up to floating-point reordering.
+
+// Portable kernel: one item at a time.
+static void evaluateScalar(const double* soa, int n, const MacroVector& goal,
+                           const double* x, MacroVector& residual) {
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        const double* row = soa + i * n;
+        double sum = 0.0;
+        for (int j = 0; j < n; j++) {
+            sum += row[j] * x[j];
+        }
+        residual[i] = sum - goal[i];
+    }
+}
+
+static void scoreDeltasScalar(const double* soa, int n, const MacroVector& r,
+                              double delta, double* out, int begin = 0) {
+    for (int j = begin; j < n; j++) {
+        double sum = 0.0;
+        for (int i = 0; i < MACRO_COUNT; i++) {
+            double t = r[i] + delta * soa[i * n + j];
+            sum += t * t;
+        }
+        out[j] = sum;
+    }
+}
+
+#ifdef BATCH_EVALUATOR_X86
+
+// SSE2 kernel: two items per instruction.
+__attribute__((target("sse2")))
+static void evaluateSse2(const double* soa, int n, const MacroVector& goal,
+                         const double* x, MacroVector& residual) {
+    int wide = n & ~1;
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        const double* row = soa + i * n;
+        __m128d acc = _mm_setzero_pd();
+        for (int j = 0; j < wide; j += 2) {
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(row + j), _mm_loadu_pd(x + j)));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc);
+        double sum = lanes[0] + lanes[1];
+        for (int j = wide; j < n; j++) {
+            sum += row[j] * x[j];
+        }
+        residual[i] = sum - goal[i];
+    }
+}
+
+__attribute__((target("sse2")))
+static void scoreDeltasSse2(const double* soa, int n, const MacroVector& r,
+                            double delta, double* out) {
+    int wide = n & ~1;
+    __m128d d = _mm_set1_pd(delta);
+    for (int j = 0; j < wide; j += 2) {
+        __m128d sum = _mm_setzero_pd();
+        for (int i = 0; i < MACRO_COUNT; i++) {
+            __m128d t = _mm_add_pd(_mm_set1_pd(r[i]),
+                                   _mm_mul_pd(d, _mm_loadu_pd(soa + i * n + j)));
+            sum = _mm_add_pd(sum, _mm_mul_pd(t, t));
+        }
+        _mm_storeu_pd(out + j, sum);
+    }
+    scoreDeltasScalar(soa, n, r, delta, out, wide);
+}
+
+// AVX2 kernel: four items per instruction.
+__attribute__((target("avx2")))
+static void evaluateAvx2(const double* soa, int n, const MacroVector& goal,
+                         const double* x, MacroVector& residual) {
+    int wide = n & ~3;
+    __m256d acc[MACRO_COUNT];
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        acc[i] = _mm256_setzero_pd();
+    }
+    // One load of x feeds every macro row.
+    for (int j = 0; j < wide; j += 4) {
+        __m256d xv = _mm256_loadu_pd(x + j);
+        for (int i = 0; i < MACRO_COUNT; i++) {
+            acc[i] = _mm256_add_pd(acc[i], _mm256_mul_pd(_mm256_loadu_pd(soa + i * n + j), xv));
+        }
+    }
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc[i]);
+        double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        const double* row = soa + i * n;
+        for (int j = wide; j < n; j++) {
+            sum += row[j] * x[j];
+        }
+        residual[i] = sum - goal[i];
+    }
+}
+
+__attribute__((target("avx2")))
+static void scoreDeltasAvx2(const double* soa, int n, const MacroVector& r,
+                            double delta, double* out) {
+    int wide = n & ~3;
+    __m256d d = _mm256_set1_pd(delta);
+    for (int j = 0; j < wide; j += 4) {
+        __m256d sum = _mm256_setzero_pd();
+        for (int i = 0; i < MACRO_COUNT; i++) {
+            __m256d t = _mm256_add_pd(_mm256_set1_pd(r[i]),
+                                      _mm256_mul_pd(d, _mm256_loadu_pd(soa + i * n + j)));
+            sum = _mm256_add_pd(sum, _mm256_mul_pd(t, t));
+        }
+        _mm256_storeu_pd(out + j, sum);
+    }
+    scoreDeltasScalar(soa, n, r, delta, out, wide);
+}
+
+#endif
+
+// Checks the CPU once; only x86 builds have vector kernels.
+KernelIsa BatchEvaluator::bestIsa() {
+#ifdef BATCH_EVALUATOR_X86
+    static const KernelIsa best = __builtin_cpu_supports("avx2") ? KernelIsa::Avx2
+                                : __builtin_cpu_supports("sse2") ? KernelIsa::Sse2
+                                : KernelIsa::Scalar;
+    return best;
+#else
+    return KernelIsa::Scalar;
+#endif
+}
+
+const char* BatchEvaluator::isaName(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::Avx2: return "avx2";
+        case KernelIsa::Sse2: return "sse2";
+        default:              return "scalar";
+    }
+}
+
+BatchEvaluator::BatchEvaluator() : itemCount(0), goal{}, isa(KernelIsa::Scalar) {}
+
+// Transposes the item-major macros into one row per macro.
+BatchEvaluator::BatchEvaluator(const vector<MacroVector>& items,
+                               const MacroVector& goalMacros, KernelIsa wanted)
+    : itemCount(static_cast<int>(items.size())),
+      soa(static_cast<size_t>(MACRO_COUNT) * items.size()),
+      goal(goalMacros),
+      isa(wanted) {
+    for (int j = 0; j < itemCount; j++) {
+        for (int i = 0; i < MACRO_COUNT; i++) {
+            soa[i * itemCount + j] = items[j][i];
+        }
+    }
+    if (static_cast<int>(isa) > static_cast<int>(bestIsa())) {
+        isa = bestIsa();
+    }
+}
+
+MacroVector BatchEvaluator::residual(const double* servings) const {
+    MacroVector r;
+    switch (isa) {
+#ifdef BATCH_EVALUATOR_X86
+        case KernelIsa::Avx2: evaluateAvx2(soa.data(), itemCount, goal, servings, r); break;
+        case KernelIsa::Sse2: evaluateSse2(soa.data(), itemCount, goal, servings, r); break;
+#endif
+        default:              evaluateScalar(soa.data(), itemCount, goal, servings, r); break;
+    }
+    return r;
+}
+
+double BatchEvaluator::objective(const MacroVector& residual) {
+    double sum = 0.0;
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        sum += residual[i] * residual[i];
+    }
+    return sum;
+}
+
+void BatchEvaluator::evaluate(const double* servings, size_t count,
+                              double* objectives) const {
+    for (size_t c = 0; c < count; c++) {
+        objectives[c] = objective(residual(servings + c * itemCount));
+    }
+}
+
+// Only the changed item's column enters the residual, so this is O(1)
+// in the menu size.
+void BatchEvaluator::applyDelta(MacroVector& residual, int item,
+                                double delta) const {
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        residual[i] += delta * soa[i * itemCount + item];
+    }
+}
+
+void BatchEvaluator::scoreDeltas(const MacroVector& residual, double delta,
+                                 double* objectives) const {
+    switch (isa) {
+#ifdef BATCH_EVALUATOR_X86
+        case KernelIsa::Avx2: scoreDeltasAvx2(soa.data(), itemCount, residual, delta, objectives); break;
+        case KernelIsa::Sse2: scoreDeltasSse2(soa.data(), itemCount, residual, delta, objectives); break;
+#endif
+        default:              scoreDeltasScalar(soa.data(), itemCount, residual, delta, objectives); break;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include "PlanningEngine.h"
+#include <cstddef>
+#include <vector>
+
+// Instruction sets the evaluation kernels are compiled for.
+enum class KernelIsa { Scalar, Sse2, Avx2 };
+
+// Evaluates the squared macro error ||Ax - g||^2 of many candidate
+// serving vectors against one menu. The macro matrix is stored as one
+// contiguous row per macro (structure of arrays) so the kernels can load
+// several items' values for the same macro at once.
+class BatchEvaluator {
+private:
+    int itemCount;
+    // soa[i * itemCount + j] is macro i of item j.
+    std::vector<double> soa;
+    MacroVector goal;
+    KernelIsa isa;
+
+public:
+    // Returns the widest instruction set this CPU supports.
+    static KernelIsa bestIsa();
+
+    // Returns a printable name for an instruction set.
+    static const char* isaName(KernelIsa isa);
+
+    BatchEvaluator();
+
+    // Lays out the items' macros by macro and picks the kernel to use;
+    // requesting an unsupported instruction set falls back to the best
+    // supported one.
+    BatchEvaluator(const std::vector<MacroVector>& items, const MacroVector& goal,
+                   KernelIsa isa = bestIsa());
+
+    int size() const { return itemCount; }
+    KernelIsa kernel() const { return isa; }
+
+    // Scores count candidates stored row-major in servings (count rows of
+    // size() servings each) and writes one objective per candidate.
+    void evaluate(const double* servings, std::size_t count,
+                  double* objectives) const;
+
+    // Returns the residual Ax - g of one serving vector.
+    MacroVector residual(const double* servings) const;
+
+    // Returns the objective of a residual.
+    static double objective(const MacroVector& residual);
+
+    // Updates a residual in place after item's serving changes by delta.
+    void applyDelta(MacroVector& residual, int item, double delta) const;
+
+    // For every item j, writes the objective that would result from
+    // changing item j's serving by delta, starting from residual.
+    void scoreDeltas(const MacroVector& residual, double delta,
+                     double* objectives) const;
+};
+
+#endif
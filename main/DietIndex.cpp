@@ -0,0 +1,191 @@
+#include "DietIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <numeric>
+
+using namespace std;
+
+// Diet names and the icons that satisfy them; any one icon suffices.
+static const map<string, vector<string>> DIET_ICONS = {
+    {"vegan",           {"VG"}},
+    {"vegetarian",      {"V", "VG"}},
+    {"gluten free",     {"GFI"}},
+    {"gluten-free",     {"GFI"}},
+    {"gluten friendly", {"GFI"}},
+};
+
+// Returns true if code is one of the icons a diet name maps to.
+static bool knownIcon(const string& code) {
+    for (const auto& diet : DIET_ICONS) {
+        if (find(diet.second.begin(), diet.second.end(), code) != diet.second.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Trims leading and trailing whitespace from a string.
+static string trim(const string& str) {
+    size_t first = str.find_first_not_of(" \t\n\r");
+    if (first == string::npos) return "";
+    size_t last = str.find_last_not_of(" \t\n\r");
+    return str.substr(first, last - first + 1);
+}
+
+// Returns text with every letter in upper case.
+static string toUpper(string text) {
+    for (char& c : text) {
+        c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+// Appends j to a posting list unless it is already the last entry.
+static void post(vector<int>& list, int j) {
+    if (list.empty() || list.back() != j) {
+        list.push_back(j);
+    }
+}
+
+// Creates an index over an empty menu.
+DietIndex::DietIndex() : itemCount(0) {}
+
+// Items are visited in menu order, so every posting list comes out sorted.
+DietIndex::DietIndex(const vector<FoodItem>& menu) : itemCount(menu.size()) {
+    for (size_t j = 0; j < menu.size(); j++) {
+        for (const string& icon : menu[j].icons) {
+            post(iconPostings[toUpper(trim(icon))], static_cast<int>(j));
+        }
+        vector<string> tokens = tokenize(menu[j].ingredients);
+        for (const string& token : tokens) {
+            post(tokenPostings[token], static_cast<int>(j));
+        }
+        if (tokens.empty()) {
+            unknownIngredients.push_back(static_cast<int>(j));
+        }
+    }
+}
+
+// Looks key up in one of the posting maps.
+const vector<int>& DietIndex::postings(const map<string, vector<int>>& index,
+                                       const string& key) {
+    static const vector<int> none;
+    auto it = index.find(key);
+    return it == index.end() ? none : it->second;
+}
+
+// Scans text once, ending a token at every non-alphanumeric character.
+vector<string> DietIndex::tokenize(const string& text) {
+    vector<string> tokens;
+    string token;
+    for (size_t i = 0; i <= text.size(); i++) {
+        unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+        if (isalnum(c)) {
+            token += static_cast<char>(tolower(c));
+            continue;
+        }
+        if (token.size() > 3 && token.back() == 's' && token[token.size() - 2] != 's') {
+            token.pop_back();
+        }
+        if (!token.empty()) {
+            tokens.push_back(token);
+        }
+        token.clear();
+    }
+    return tokens;
+}
+
+// Terms are split on ',' or ';' and lowercased before they are matched.
+DietFilter DietIndex::parseFilter(const string& text) {
+    DietFilter filter;
+    string term;
+    for (size_t i = 0; i <= text.size(); i++) {
+        if (i < text.size() && text[i] != ',' && text[i] != ';') {
+            term += static_cast<char>(tolower(static_cast<unsigned char>(text[i])));
+            continue;
+        }
+        term = trim(term);
+        string phrase;
+        if (DIET_ICONS.count(term)) {
+            filter.requiredIcons.push_back(DIET_ICONS.at(term));
+        } else if (term.rfind("no ", 0) == 0) {
+            phrase = term.substr(3);
+        } else if (term.rfind("without ", 0) == 0) {
+            phrase = term.substr(8);
+        } else if (term.size() > 5 && (term.compare(term.size() - 5, 5, "-free") == 0
+                                       || term.compare(term.size() - 5, 5, " free") == 0)) {
+            phrase = term.substr(0, term.size() - 5);
+        } else if (knownIcon(toUpper(term))) {
+            filter.requiredIcons.push_back({toUpper(term)});
+        } else if (!term.empty()) {
+            filter.unknownTerms.push_back(term);
+        }
+
+        vector<string> tokens = tokenize(phrase);
+        if (!tokens.empty()) {
+            filter.excludedIngredients.push_back(tokens);
+        }
+        term.clear();
+    }
+    return filter;
+}
+
+// Starts from every item and narrows by icon groups, then ingredient phrases.
+vector<int> DietIndex::matching(const DietFilter& filter) const {
+    vector<int> result(itemCount);
+    iota(result.begin(), result.end(), 0);
+
+    // Intersect with the union of each required group's icon postings.
+    for (const auto& group : filter.requiredIcons) {
+        vector<int> allowed;
+        for (const string& icon : group) {
+            const vector<int>& list = postings(iconPostings, icon);
+            vector<int> merged;
+            set_union(allowed.begin(), allowed.end(), list.begin(), list.end(),
+                      back_inserter(merged));
+            allowed.swap(merged);
+        }
+        vector<int> kept;
+        set_intersection(result.begin(), result.end(), allowed.begin(), allowed.end(),
+                         back_inserter(kept));
+        result.swap(kept);
+    }
+
+    // Remove items whose ingredients hold every token of an excluded phrase.
+    for (const auto& phrase : filter.excludedIngredients) {
+        vector<int> hits = postings(tokenPostings, phrase.front());
+        for (size_t t = 1; t < phrase.size() && !hits.empty(); t++) {
+            const vector<int>& list = postings(tokenPostings, phrase[t]);
+            vector<int> both;
+            set_intersection(hits.begin(), hits.end(), list.begin(), list.end(),
+                             back_inserter(both));
+            hits.swap(both);
+        }
+        vector<int> kept;
+        set_difference(result.begin(), result.end(), hits.begin(), hits.end(),
+                       back_inserter(kept));
+        result.swap(kept);
+    }
+
+    // Nothing shows that an item without ingredient text is free of them.
+    if (!filter.excludedIngredients.empty()) {
+        vector<int> kept;
+        set_difference(result.begin(), result.end(), unknownIngredients.begin(),
+                       unknownIngredients.end(), back_inserter(kept));
+        result.swap(kept);
+    }
+    return result;
+}
+
+// Inverts matching() into a mask over the whole menu.
+vector<bool> DietIndex::excluded(const DietFilter& filter) const {
+    if (filter.empty()) {
+        return vector<bool>();
+    }
+    vector<bool> mask(itemCount, true);
+    for (int j : matching(filter)) {
+        mask[j] = false;
+    }
+    return mask;
+}
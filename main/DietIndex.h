@@ -0,0 +1,72 @@
+#ifndef DIETINDEX_H
+#define DIETINDEX_H
+
+#include "User.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// A parsed diet and allergen filter.
+struct DietFilter {
+    // Every item must carry at least one icon from each group, e.g.
+    // {"V", "VG"} for "vegetarian".
+    std::vector<std::vector<std::string>> requiredIcons;
+
+    // No item may contain every token of any of these phrases, e.g.
+    // {"tree", "nut"} for "no tree nuts".
+    std::vector<std::vector<std::string>> excludedIngredients;
+
+    // Terms that name no known diet, icon code, or exclusion, such as a
+    // misspelled "vegn". They are ignored rather than required as icons,
+    // which would empty every menu.
+    std::vector<std::string> unknownTerms;
+
+    bool empty() const { return requiredIcons.empty() && excludedIngredients.empty(); }
+};
+
+// Inverted index from diet icon and ingredient token to the menu items
+// that carry them, built once per menu so a filter costs a few posting
+// list merges instead of a scan of every item's text. Items without
+// ingredient text fail every ingredient exclusion: nothing rules out the
+// allergen, so they are kept out rather than trusted.
+class DietIndex {
+private:
+    std::size_t itemCount;
+    // Sorted menu indices per uppercase icon and per ingredient token.
+    std::map<std::string, std::vector<int>> iconPostings;
+    std::map<std::string, std::vector<int>> tokenPostings;
+    // Sorted menu indices of the items with no ingredient tokens.
+    std::vector<int> unknownIngredients;
+
+    // Returns the posting list for key, or an empty list.
+    static const std::vector<int>& postings(
+        const std::map<std::string, std::vector<int>>& index, const std::string& key);
+
+public:
+    DietIndex();
+
+    // Indexes every item's icons and ingredient tokens.
+    explicit DietIndex(const std::vector<FoodItem>& menu);
+
+    // Splits text into lowercase alphanumeric tokens with a plural 's'
+    // dropped, so "Peanuts," and "peanut" match.
+    static std::vector<std::string> tokenize(const std::string& text);
+
+    // Parses comma-separated terms such as "vegan, gluten free, no
+    // peanuts, shellfish-free". "no X", "without X", and "X-free" exclude
+    // an ingredient; diet names ("vegan", "vegetarian", "gluten free") and
+    // their icon codes ("V", "VG", "GFI") require an icon. Anything else is
+    // collected in unknownTerms.
+    static DietFilter parseFilter(const std::string& text);
+
+    // Returns the sorted menu indices of the items that pass the filter;
+    // items with unknown ingredients never pass an ingredient exclusion.
+    std::vector<int> matching(const DietFilter& filter) const;
+
+    // Returns a per-item mask, true for items the filter rules out; empty
+    // when the filter is empty.
+    std::vector<bool> excluded(const DietFilter& filter) const;
+};
+
+#endif
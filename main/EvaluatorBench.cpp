@@ -0,0 +1,124 @@
+// Micro-benchmark for BatchEvaluator: times full batch evaluation and
+// per-item delta scoring with each supported kernel on a synthetic menu,
+// and checks that every kernel agrees with the scalar one.
+#include "BatchEvaluator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// Builds a menu whose calories follow from its macros, like real items.
+static vector<MacroVector> makeMenu(int n, mt19937& rng) {
+    uniform_real_distribution<double> protein(0, 30), carbs(0, 60), fat(0, 25);
+    vector<MacroVector> items;
+    for (int j = 0; j < n; j++) {
+        double p = protein(rng), c = carbs(rng), f = fat(rng);
+        items.push_back({4 * p + 4 * c + 9 * f, p, c, f});
+    }
+    return items;
+}
+
+// Returns nanoseconds per call of fn, averaged over repeat runs.
+template <typename F>
+static double timeNs(F fn, int repeat) {
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < repeat; r++) {
+        fn();
+    }
+    return chrono::duration<double, nano>(Clock::now() - start).count() / repeat;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 128;
+    int batch = argc > 2 ? atoi(argv[2]) : 4096;
+    int repeat = 20;
+
+    mt19937 rng(42);
+    vector<MacroVector> items = makeMenu(n, rng);
+    MacroVector goal = {700, 50, 90, 20};
+
+    // Sparse plans like the planner produces: a few items at 0.5..3 servings.
+    vector<double> servings(static_cast<size_t>(batch) * n, 0.0);
+    uniform_int_distribution<int> pickItem(0, n - 1), pickLevel(1, 6);
+    for (int c = 0; c < batch; c++) {
+        for (int k = 0; k < 6; k++) {
+            servings[c * n + pickItem(rng)] = 0.5 * pickLevel(rng);
+        }
+    }
+
+    cout << "Batch evaluator benchmark: " << n << " items, " << batch
+         << " candidates (best kernel: "
+         << BatchEvaluator::isaName(BatchEvaluator::bestIsa()) << ")" << endl;
+    cout << left << setw(8) << "kernel" << right << setw(16) << "ns/candidate"
+         << setw(14) << "ns/delta-row" << setw(12) << "speedup" << setw(12)
+         << "max diff" << endl;
+
+    BatchEvaluator scalar(items, goal, KernelIsa::Scalar);
+    vector<double> reference(batch);
+    scalar.evaluate(servings.data(), batch, reference.data());
+
+    MacroVector residual = scalar.residual(servings.data());
+    double scalarNs = 0.0;
+    for (KernelIsa isa : {KernelIsa::Scalar, KernelIsa::Sse2, KernelIsa::Avx2}) {
+        BatchEvaluator evaluator(items, goal, isa);
+        if (evaluator.kernel() != isa) {
+            cout << left << setw(8) << BatchEvaluator::isaName(isa)
+                 << "  not supported on this CPU" << endl;
+            continue;
+        }
+
+        vector<double> objectives(batch);
+        double evalNs = timeNs([&]() {
+            evaluator.evaluate(servings.data(), batch, objectives.data());
+        }, repeat) / batch;
+
+        vector<double> deltas(n);
+        double deltaNs = timeNs([&]() {
+            evaluator.scoreDeltas(residual, 0.5, deltas.data());
+        }, repeat * 100);
+
+        double maxDiff = 0.0;
+        for (int c = 0; c < batch; c++) {
+            maxDiff = max(maxDiff, fabs(objectives[c] - reference[c]));
+        }
+        if (isa == KernelIsa::Scalar) {
+            scalarNs = evalNs;
+        }
+
+        cout << left << setw(8) << BatchEvaluator::isaName(isa) << right
+             << fixed << setprecision(1) << setw(16) << evalNs << setw(14)
+             << deltaNs << setw(11) << setprecision(2) << scalarNs / evalNs
+             << "x" << setw(12) << scientific << setprecision(1) << maxDiff
+             << defaultfloat << endl;
+    }
+
+    // Incremental updates: one item changes, residual updates in O(1).
+    // Both loops alternate +/- half a serving so they end where they began.
+    BatchEvaluator evaluator(items, goal);
+    vector<double> plan(servings.begin(), servings.begin() + n);
+    MacroVector r = evaluator.residual(plan.data());
+    double step = 0.5;
+    double fullNs = timeNs([&]() {
+        plan[0] += step;
+        step = -step;
+        r = evaluator.residual(plan.data());
+    }, repeat * 1000);
+    double incrementalNs = timeNs([&]() {
+        evaluator.applyDelta(r, 0, step);
+        step = -step;
+    }, repeat * 1000);
+    double exact = BatchEvaluator::objective(evaluator.residual(plan.data()));
+    cout << "single-item change: full " << fixed << setprecision(1) << fullNs
+         << " ns, incremental " << incrementalNs << " ns, drift "
+         << scientific << setprecision(1)
+         << fabs(BatchEvaluator::objective(r) - exact) << endl;
+
+    return 0;
+}
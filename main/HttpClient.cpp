@@ -0,0 +1,317 @@
+#include "HttpClient.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#endif
+
+using namespace std;
+
+#ifndef _WIN32
+
+// Lowercases a header name for comparison.
+static string toLower(string text) {
+    for (char& c : text) {
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+// Decodes a chunked body into out; false until the final chunk has arrived.
+static bool decodeChunked(const string& body, string& out) {
+    out.clear();
+    size_t pos = 0;
+    while (true) {
+        size_t lineEnd = body.find("\r\n", pos);
+        if (lineEnd == string::npos) return false;
+        size_t size = strtoul(body.substr(pos, lineEnd - pos).c_str(), nullptr, 16);
+        pos = lineEnd + 2;
+        if (size == 0) return true;
+        if (pos + size + 2 > body.size()) return false;
+        out.append(body, pos, size);
+        pos += size + 2;
+    }
+}
+
+namespace {
+
+// One open connection, plain or over TLS.
+struct Connection {
+    int fd = -1;
+#ifdef HAVE_OPENSSL
+    SSL* ssl = nullptr;
+#endif
+
+    ~Connection() {
+#ifdef HAVE_OPENSSL
+        if (ssl) {
+            SSL_shutdown(ssl);
+            SSL_free(ssl);
+        }
+#endif
+        if (fd >= 0) close(fd);
+    }
+
+    bool sendAll(const string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            long count;
+#ifdef HAVE_OPENSSL
+            if (ssl) {
+                count = SSL_write(ssl, data.data() + sent, static_cast<int>(data.size() - sent));
+            } else
+#endif
+            {
+                count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            }
+            if (count <= 0) return false;
+            sent += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    // Reads some bytes; 0 at end of stream, negative on error or timeout.
+    long receive(char* buffer, size_t size) {
+#ifdef HAVE_OPENSSL
+        if (ssl) {
+            int count = SSL_read(ssl, buffer, static_cast<int>(size));
+            if (count > 0) return count;
+            int error = SSL_get_error(ssl, count);
+            return error == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+        }
+#endif
+        return recv(fd, buffer, size, 0);
+    }
+};
+
+#ifdef HAVE_OPENSSL
+// Client context shared by every request, verifying against the system's
+// trusted certificates.
+SSL_CTX* tlsContext() {
+    static SSL_CTX* context = [] {
+        SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+        if (ctx) {
+            SSL_CTX_set_default_verify_paths(ctx);
+            SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+            SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+        }
+        return ctx;
+    }();
+    return context;
+}
+#endif
+
+// Connects to host:port within timeoutMs, then applies the same timeout
+// to every read and write.
+bool openSocket(const string& host, const string& port, int timeoutMs, int& fd,
+                string& error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses);
+    if (status != 0) {
+        error = string("cannot resolve ") + host + ": " + gai_strerror(status);
+        return false;
+    }
+
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        // Close-on-exec, so solver workers forked meanwhile never hold it;
+        // atomically where SOCK_CLOEXEC exists, right after creation elsewhere.
+#ifdef __linux__
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC,
+                    address->ai_protocol);
+        if (fd < 0) continue;
+#else
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        bool connected = connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+        if (!connected && errno == EINPROGRESS) {
+            pollfd waiter{fd, POLLOUT, 0};
+            int socketError = 0;
+            socklen_t length = sizeof(socketError);
+            connected = poll(&waiter, 1, timeoutMs) == 1 &&
+                        getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length) == 0 &&
+                        socketError == 0;
+        }
+        if (connected) {
+            fcntl(fd, F_SETFL, flags);
+            timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        error = "cannot connect to " + host + ":" + port;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool HttpClient::get(const string& url, Response& response, int timeoutMs) {
+    response = Response();
+
+    // Split scheme://host[:port]/path.
+    size_t schemeEnd = url.find("://");
+    string scheme = schemeEnd == string::npos ? "" : toLower(url.substr(0, schemeEnd));
+    if (scheme != "http" && scheme != "https") {
+        response.error = "unsupported URL " + url;
+        return false;
+    }
+    size_t hostStart = schemeEnd + 3;
+    size_t pathStart = url.find('/', hostStart);
+    string authority = url.substr(hostStart, pathStart - hostStart);
+    string path = pathStart == string::npos ? "/" : url.substr(pathStart);
+    string host = authority;
+    string port = scheme == "https" ? "443" : "80";
+    size_t colon = authority.rfind(':');
+    if (colon != string::npos) {
+        host = authority.substr(0, colon);
+        port = authority.substr(colon + 1);
+    }
+
+    Connection connection;
+    if (!openSocket(host, port, timeoutMs, connection.fd, response.error)) {
+        return false;
+    }
+
+    if (scheme == "https") {
+#ifdef HAVE_OPENSSL
+        SSL_CTX* context = tlsContext();
+        connection.ssl = context ? SSL_new(context) : nullptr;
+        if (!connection.ssl) {
+            response.error = "cannot create a TLS session";
+            return false;
+        }
+        SSL_set_fd(connection.ssl, connection.fd);
+        SSL_set_tlsext_host_name(connection.ssl, host.c_str());
+        SSL_set1_host(connection.ssl, host.c_str());
+        if (SSL_connect(connection.ssl) != 1) {
+            char reason[256];
+            ERR_error_string_n(ERR_get_error(), reason, sizeof(reason));
+            response.error = "TLS handshake with " + host + " failed: " + reason;
+            return false;
+        }
+#else
+        response.error = "built without TLS; https:// needs TLS=1";
+        return false;
+#endif
+    }
+
+    string request = "GET " + path + " HTTP/1.1\r\nHost: " + authority +
+                     "\r\nAccept: application/json\r\nConnection: close\r\n\r\n";
+    if (!connection.sendAll(request)) {
+        response.error = "cannot send request to " + host;
+        return false;
+    }
+
+    // Read until the body is complete or the server closes the connection.
+    string data;
+    size_t headerEnd = string::npos;
+    long contentLength = -1;
+    bool chunked = false;
+    char buffer[16384];
+    while (true) {
+        long count = connection.receive(buffer, sizeof(buffer));
+        if (count < 0) {
+            response.error = "read from " + host + " failed or timed out";
+            return false;
+        }
+        if (count == 0) break;
+        data.append(buffer, static_cast<size_t>(count));
+
+        if (headerEnd == string::npos) {
+            headerEnd = data.find("\r\n\r\n");
+            if (headerEnd == string::npos) continue;
+
+            istringstream headers(data.substr(0, headerEnd));
+            string line;
+            getline(headers, line);
+            size_t space = line.find(' ');
+            response.status = space == string::npos ? 0 : atoi(line.c_str() + space + 1);
+            while (getline(headers, line)) {
+                size_t separator = line.find(':');
+                if (separator == string::npos) continue;
+                string name = toLower(line.substr(0, separator));
+                string value = toLower(line.substr(separator + 1));
+                if (name == "content-length") {
+                    contentLength = atol(value.c_str());
+                } else if (name == "transfer-encoding" &&
+                           value.find("chunked") != string::npos) {
+                    chunked = true;
+                }
+            }
+        }
+
+        size_t bodySize = data.size() - (headerEnd + 4);
+        if (!chunked && contentLength >= 0 && bodySize >= static_cast<size_t>(contentLength)) {
+            break;
+        }
+        if (chunked && data.compare(data.size() - min<size_t>(5, data.size()),
+                                    string::npos, "0\r\n\r\n") == 0) {
+            break;
+        }
+    }
+
+    if (headerEnd == string::npos) {
+        response.error = "incomplete response from " + host;
+        return false;
+    }
+    string body = data.substr(headerEnd + 4);
+    if (chunked) {
+        if (!decodeChunked(body, response.body)) {
+            response.error = "truncated chunked response from " + host;
+            return false;
+        }
+    } else {
+        if (contentLength >= 0 && body.size() < static_cast<size_t>(contentLength)) {
+            response.error = "truncated response from " + host;
+            return false;
+        }
+        if (contentLength >= 0) {
+            body.resize(static_cast<size_t>(contentLength));
+        }
+        response.body.swap(body);
+    }
+    return true;
+}
+
+#else
+
+bool HttpClient::get(const string& url, Response& response, int timeoutMs) {
+    (void)url;
+    (void)timeoutMs;
+    response = Response();
+    response.error = "native HTTP is not available on Windows";
+    return false;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <string>
+
+// Minimal blocking HTTP/1.1 client for GET requests, one connection per
+// request. http:// URLs use plain sockets; https:// URLs need a build with
+// OpenSSL (TLS=1 in the Makefile, which defines HAVE_OPENSSL). Bodies may
+// be sent with Content-Length, chunked, or delimited by the connection
+// closing. Not available on Windows.
+class HttpClient {
+public:
+    // Outcome of one request; error is set when no response was read.
+    struct Response {
+        int status = 0;
+        std::string body;
+        std::string error;
+    };
+
+    // Fetches url, giving up after timeoutMs for connecting and for each
+    // read or write; true if a response (of any status) was read.
+    static bool get(const std::string& url, Response& response, int timeoutMs);
+};
+
+#endif
@@ -0,0 +1,97 @@
+// Benchmark for native Nutrislice ingestion: fetches one recorded week
+// repeatedly from a base URL (normally nutrislice_standin.py) on several
+// threads and reports request latency, parse time, and throughput.
+#include "HttpClient.h"
+#include "Nutrislice.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+int main(int argc, char* argv[]) {
+    NutrisliceClient::Config config;
+    config.baseUrl = argc > 1 ? argv[1] : "http://127.0.0.1:8765";
+    string mealType = argc > 2 ? argv[2] : "lunch";
+    string date = argc > 3 ? argv[3] : "2026-10-19";
+    int requests = argc > 4 ? atoi(argv[4]) : 200;
+    int threads = argc > 5 ? atoi(argv[5]) : 4;
+    NutrisliceClient client(config);
+    string url = client.weekUrl(mealType, date);
+
+    // One request up front checks the fixture and times parsing alone.
+    HttpClient::Response first;
+    if (!HttpClient::get(url, first, config.timeoutMs) || first.status != 200) {
+        cerr << "Error: " << url << ": "
+             << (first.error.empty() ? "status " + to_string(first.status) : first.error) << endl;
+        return 1;
+    }
+    NutrisliceClient::WeekMenus week;
+    string error;
+    int parseRepeat = 50;
+    Clock::time_point parseStart = Clock::now();
+    for (int r = 0; r < parseRepeat; r++) {
+        week.clear();
+        if (!NutrisliceClient::parseWeek(first.body, week, error)) {
+            cerr << "Error: " << error << endl;
+            return 1;
+        }
+    }
+    double parseMs = chrono::duration<double, milli>(Clock::now() - parseStart).count()
+                     / parseRepeat;
+    size_t items = 0;
+    for (const auto& day : week) items += day.second.size();
+
+    cout << "Ingestion benchmark: " << url << "\n"
+         << "  response " << first.body.size() / 1024 << " KiB, " << week.size() << " days, "
+         << items << " items; parse " << fixed << setprecision(2) << parseMs << " ms\n";
+
+    // Fetch and parse the week requests times across the threads.
+    vector<double> latencies;
+    mutex latencyMutex;
+    atomic<int> next(0), failures(0);
+    Clock::time_point start = Clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            while (next++ < requests) {
+                Clock::time_point begin = Clock::now();
+                NutrisliceClient::WeekMenus fetched;
+                string fetchError;
+                if (!client.fetchWeek(mealType, date, fetched, fetchError)) {
+                    failures++;
+                    continue;
+                }
+                double ms = chrono::duration<double, milli>(Clock::now() - begin).count();
+                lock_guard<mutex> lock(latencyMutex);
+                latencies.push_back(ms);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    if (latencies.empty()) {
+        cerr << "Error: every request failed" << endl;
+        return 1;
+    }
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    cout << "  " << latencies.size() << " weeks on " << threads << " threads in "
+         << seconds << " s: " << setprecision(1) << latencies.size() / seconds
+         << " weeks/s, " << setprecision(0) << latencies.size() * items / seconds
+         << " items/s\n"
+         << "  latency ms: p50 " << setprecision(2) << percentile(0.5) << ", p95 "
+         << percentile(0.95) << ", max " << latencies.back() << "; " << failures
+         << " failed\n";
+    return failures > 0 ? 1 : 0;
+}
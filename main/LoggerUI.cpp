@@ -67,7 +67,6 @@ void LoggerUI::showFoodLogger() {
         case 3: mealType = "dinner"; break;
     }
 
-    UIUtils::fetchMenuFor(dateStr, mealType);
     auto menu = menuManager.getDailyMenu(mealType, dateStr);
     
     if (menu.empty()) {
@@ -148,7 +147,7 @@ void LoggerUI::showFoodLogger() {
                  << CYAN << menu[itemNumber - 1].name << RESET 
                  << " x" << YELLOW << fixed << setprecision(1) << servings << RESET 
                  << " (" << GREEN
-                 << static_cast<int>(menu[itemNumber - 1].calories * servings)
+                 << static_cast<int>(menu[itemNumber - 1].nutrients[Nutrient::Calories] * servings)
                  << " cal" << RESET << ")\n";
             cout << "\n";
             UIUtils::printSeparator();
@@ -233,10 +232,10 @@ void LoggerUI::showLoggedFoods() {
                     
                     for (const auto& item : menu) {
                         if (item.name == foodName) {
-                            totalCals    = static_cast<int>(item.calories * servings);
-                            totalProtein = item.protein * servings;
-                            totalCarbs   = item.carbs * servings;
-                            totalFats    = item.fats * servings;
+                            totalCals    = static_cast<int>(item.nutrients[Nutrient::Calories] * servings);
+                            totalProtein = item.nutrients[Nutrient::Protein] * servings;
+                            totalCarbs   = item.nutrients[Nutrient::Carbs] * servings;
+                            totalFats    = item.nutrients[Nutrient::Fats] * servings;
                             break;
                         }
                     }
@@ -264,10 +263,10 @@ void LoggerUI::showLoggedFoods() {
             auto totals = menuManager.calculateDailyTotals(currentUser, dateStr);
             UIUtils::printSeparator();
             cout << "\n  " << BOLD << "Daily Totals:" << RESET << "\n";
-            cout << "  " << GREEN << totals.calories << " calories" << RESET
-                 << " | " << YELLOW << "P:" << fixed << setprecision(0) << totals.protein << "g" << RESET
-                 << " " << GREEN << "C:" << totals.carbs << "g" << RESET
-                 << " " << CYAN << "F:" << totals.fats << "g" << RESET << "\n\n";
+            cout << "  " << GREEN << static_cast<int>(totals[Nutrient::Calories]) << " calories" << RESET
+                 << " | " << YELLOW << "P:" << fixed << setprecision(0) << totals[Nutrient::Protein] << "g" << RESET
+                 << " " << GREEN << "C:" << totals[Nutrient::Carbs] << "g" << RESET
+                 << " " << CYAN << "F:" << totals[Nutrient::Fats] << "g" << RESET << "\n\n";
             UIUtils::printSeparator();
             
             cout << "\n  Enter number to " << RED << "DELETE" << RESET
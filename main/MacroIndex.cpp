@@ -0,0 +1,95 @@
+#include "MacroIndex.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+// Orders neighbors so the farthest sits on top of a heap.
+static bool closer(const MacroIndex::Neighbor& a, const MacroIndex::Neighbor& b) {
+    return a.distance < b.distance;
+}
+
+MacroIndex::MacroIndex() : root(-1) {}
+
+MacroIndex::MacroIndex(const vector<MacroVector>& items) : points(items), root(-1) {
+    vector<int> order(points.size());
+    iota(order.begin(), order.end(), 0);
+    nodes.reserve(points.size());
+    root = build(order, 0, order.size());
+}
+
+int MacroIndex::build(vector<int>& order, size_t begin, size_t end) {
+    if (begin >= end) {
+        return -1;
+    }
+
+    // Split on the axis along which this subtree's items spread most.
+    int axis = 0;
+    double widest = -1.0;
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        double low = points[order[begin]][i], high = low;
+        for (size_t k = begin + 1; k < end; k++) {
+            low = min(low, points[order[k]][i]);
+            high = max(high, points[order[k]][i]);
+        }
+        if (high - low > widest) {
+            widest = high - low;
+            axis = i;
+        }
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                [&](int p, int q) { return points[p][axis] < points[q][axis]; });
+
+    int node = static_cast<int>(nodes.size());
+    nodes.push_back(Node{order[middle], axis, -1, -1});
+    int left = build(order, begin, middle);
+    int right = build(order, middle + 1, end);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    return node;
+}
+
+void MacroIndex::search(int node, const MacroVector& query, size_t count,
+                        const vector<bool>& skip, vector<Neighbor>& best) const {
+    if (node < 0) {
+        return;
+    }
+    const Node& n = nodes[node];
+
+    bool skipped = static_cast<size_t>(n.item) < skip.size() && skip[n.item];
+    if (!skipped) {
+        double distance = (points[n.item] - query).squaredNorm();
+        if (best.size() < count) {
+            best.push_back(Neighbor{n.item, distance});
+            push_heap(best.begin(), best.end(), closer);
+        } else if (distance < best.front().distance) {
+            pop_heap(best.begin(), best.end(), closer);
+            best.back() = Neighbor{n.item, distance};
+            push_heap(best.begin(), best.end(), closer);
+        }
+    }
+
+    // The far side can only help if the splitting plane is nearer than
+    // the current count-th best.
+    double offset = query[n.axis] - points[n.item][n.axis];
+    int nearSide = offset < 0.0 ? n.left : n.right;
+    int farSide = offset < 0.0 ? n.right : n.left;
+    search(nearSide, query, count, skip, best);
+    if (best.size() < count || offset * offset < best.front().distance) {
+        search(farSide, query, count, skip, best);
+    }
+}
+
+vector<MacroIndex::Neighbor> MacroIndex::nearest(const MacroVector& query, size_t count,
+                                                 const vector<bool>& skip) const {
+    vector<Neighbor> best;
+    if (count == 0) {
+        return best;
+    }
+    best.reserve(count);
+    search(root, query, count, skip, best);
+    sort_heap(best.begin(), best.end(), closer);
+    return best;
+}
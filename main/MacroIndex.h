@@ -0,0 +1,56 @@
+#ifndef MACROINDEX_H
+#define MACROINDEX_H
+
+#include "PlanningEngine.h"
+#include <cstddef>
+#include <vector>
+
+// k-d tree over one menu's per-serving planning vectors, for nearest-item
+// queries in macro space without a solve. Distances are squared Euclidean
+// in planning units, the same measure the planner's objective uses.
+class MacroIndex {
+public:
+    // One query result: a menu index and its squared distance.
+    struct Neighbor {
+        int item;
+        double distance;
+    };
+
+private:
+    // Tree node over points[item], splitting on axis at that point's
+    // coordinate; children are node indices or -1.
+    struct Node {
+        int item;
+        int axis;
+        int left;
+        int right;
+    };
+
+    std::vector<MacroVector> points;
+    std::vector<Node> nodes;
+    int root;
+
+    // Builds the subtree over order[begin, end), splitting at the median
+    // of the axis with the widest spread; returns its node index.
+    int build(std::vector<int>& order, std::size_t begin, std::size_t end);
+
+    // Descends from node, nearer side first, keeping the count best
+    // unskipped items in best as a max-heap on distance.
+    void search(int node, const MacroVector& query, std::size_t count,
+                const std::vector<bool>& skip, std::vector<Neighbor>& best) const;
+
+public:
+    MacroIndex();
+
+    // Builds the tree over the items in O(n log n).
+    explicit MacroIndex(const std::vector<MacroVector>& items);
+
+    std::size_t size() const { return points.size(); }
+
+    // Returns up to count items nearest to query, nearest first. Items
+    // with skip[j] set are left out (skip may be shorter than the menu).
+    std::vector<Neighbor> nearest(const MacroVector& query, std::size_t count,
+                                  const std::vector<bool>& skip = std::vector<bool>()) const;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include "MenuCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Manifest layout, one record per line with tab-separated fields:
+//   menu  <file name> <fetchedAt> <hash> <size> <lastUsed> <modifiedAt>
+// with times in seconds since the epoch (<modifiedAt> in file clock
+// ticks) and the hash in hex. Manifests without <modifiedAt> re-hash each
+// file once.
+static const char* MANIFEST_NAME = "manifest.tsv";
+
+static int64_t now() {
+    return static_cast<int64_t>(time(nullptr));
+}
+
+// Returns a file's modification time in seconds since the epoch.
+static int64_t modifiedAt(const fs::path& path) {
+    auto written = fs::last_write_time(path);
+    auto system = chrono::system_clock::now() +
+        chrono::duration_cast<chrono::system_clock::duration>(
+            written - fs::file_time_type::clock::now());
+    return chrono::duration_cast<chrono::seconds>(system.time_since_epoch()).count();
+}
+
+// Returns a file's modification time in file clock ticks, which catches
+// rewrites within the same second.
+static int64_t writeStamp(const fs::path& path) {
+    return static_cast<int64_t>(fs::last_write_time(path).time_since_epoch().count());
+}
+
+MenuCache::MenuCache(const string& menuDirectory)
+    : directory(menuDirectory),
+      manifestPath((fs::path(menuDirectory) / MANIFEST_NAME).string()),
+      ttlSeconds(static_cast<int64_t>(DEFAULT_TTL_HOURS) * 3600),
+      maxBytes(static_cast<uintmax_t>(DEFAULT_MAX_MB) * 1024 * 1024),
+      loaded(false), dirty(false) {}
+
+MenuCache::~MenuCache() {
+    lock_guard<mutex> lock(cacheMutex);
+    if (dirty) {
+        save();
+    }
+}
+
+void MenuCache::configure(int64_t ttl, uintmax_t bytes) {
+    lock_guard<mutex> lock(cacheMutex);
+    ttlSeconds = ttl;
+    maxBytes = bytes;
+    load();
+    evictLocked("");
+}
+
+bool MenuCache::hashFile(const string& path, uint64_t& hash, uintmax_t& size) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    hash = 1469598103934665603ULL;
+    size = 0;
+    char buffer[8192];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        streamsize count = file.gcount();
+        for (streamsize i = 0; i < count; i++) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ULL;
+        }
+        size += static_cast<uintmax_t>(count);
+    }
+    return true;
+}
+
+bool MenuCache::fresh(const string& name) {
+    lock_guard<mutex> lock(cacheMutex);
+    load();
+
+    fs::path path = fs::path(directory) / name;
+    error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    // Hash only when the size or modification time moved. A file the
+    // manifest does not know, or whose content changed since it was
+    // recorded, was written by menu.py when it last wrote the file.
+    int64_t stamp = writeStamp(path);
+    uintmax_t size = fs::file_size(path, ec);
+    auto it = entries.find(name);
+    if (it == entries.end() || it->second.size != size || it->second.modifiedAt != stamp) {
+        uint64_t hash = 0;
+        if (!hashFile(path.string(), hash, size)) {
+            return false;
+        }
+        if (it == entries.end() || it->second.hash != hash) {
+            recordLocked(name, modifiedAt(path));
+            it = entries.find(name);
+        } else {
+            it->second.size = size;
+            it->second.modifiedAt = stamp;
+        }
+        dirty = true;
+    }
+    if (now() - it->second.fetchedAt >= ttlSeconds) {
+        return false;
+    }
+
+    it->second.lastUsed = now();
+    dirty = true;
+    return true;
+}
+
+bool MenuCache::known(const string& name) {
+    lock_guard<mutex> lock(cacheMutex);
+    load();
+    error_code ec;
+    return entries.count(name) > 0 || fs::exists(fs::path(directory) / name, ec);
+}
+
+bool MenuCache::record(const string& name) {
+    lock_guard<mutex> lock(cacheMutex);
+    load();
+    if (!recordLocked(name, now())) {
+        return false;
+    }
+    evictLocked(name);
+    save();
+    return true;
+}
+
+bool MenuCache::recordLocked(const string& name, int64_t fetchedAt) {
+    Entry entry;
+    fs::path path = fs::path(directory) / name;
+    if (!hashFile(path.string(), entry.hash, entry.size)) {
+        entries.erase(name);
+        return false;
+    }
+    entry.modifiedAt = writeStamp(path);
+    entry.fetchedAt = fetchedAt;
+    entry.lastUsed = now();
+    entries[name] = entry;
+    return true;
+}
+
+void MenuCache::evictLocked(const string& keep) {
+    // Every file in the directory counts toward the limit, including the
+    // raw weekly responses and simplified menus menu.py writes alongside.
+    struct Candidate {
+        string name;
+        int64_t lastUsed;
+        uintmax_t size;
+    };
+    vector<Candidate> files;
+    uintmax_t total = 0;
+    error_code ec;
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        string name = it->path().filename().string();
+        if (name.rfind(MANIFEST_NAME, 0) == 0) continue;
+
+        uintmax_t size = it->file_size(ec);
+        auto entry = entries.find(name);
+        int64_t lastUsed = entry != entries.end() ? entry->second.lastUsed
+                                                  : modifiedAt(it->path());
+        files.push_back({name, lastUsed, size});
+        total += size;
+    }
+    if (total <= maxBytes) {
+        return;
+    }
+
+    sort(files.begin(), files.end(), [](const Candidate& a, const Candidate& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+    bool evicted = false;
+    for (const auto& file : files) {
+        if (total <= maxBytes) break;
+        if (file.name == keep) continue;
+        if (fs::remove(fs::path(directory) / file.name, ec)) {
+            total -= file.size;
+            entries.erase(file.name);
+            evicted = true;
+        }
+    }
+    if (evicted) {
+        save();
+    }
+}
+
+void MenuCache::load() {
+    if (loaded) {
+        return;
+    }
+    loaded = true;
+
+    ifstream file(manifestPath);
+    if (!file.is_open()) {
+        return;
+    }
+
+    string line;
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string tag, name;
+        getline(fields, tag, '\t');
+        getline(fields, name, '\t');
+        if (tag != "menu" || name.empty()) {
+            continue;
+        }
+        Entry entry;
+        if (fields >> entry.fetchedAt >> hex >> entry.hash >> dec >> entry.size
+                   >> entry.lastUsed) {
+            if (!(fields >> entry.modifiedAt)) {
+                entry.modifiedAt = 0;
+            }
+            entries[name] = entry;
+        }
+    }
+}
+
+void MenuCache::save() {
+    dirty = false;
+    error_code ec;
+    fs::create_directories(directory, ec);
+
+    string tempPath = manifestPath + ".tmp";
+    {
+        ofstream file(tempPath, ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        for (const auto& entry : entries) {
+            file << "menu\t" << entry.first << '\t' << entry.second.fetchedAt << '\t'
+                 << hex << entry.second.hash << dec << '\t' << entry.second.size << '\t'
+                 << entry.second.lastUsed << '\t' << entry.second.modifiedAt << '\n';
+        }
+    }
+    fs::rename(tempPath, manifestPath, ec);
+    if (ec) {
+        remove(tempPath.c_str());
+    }
+}
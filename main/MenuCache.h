@@ -0,0 +1,88 @@
+#ifndef MENUCACHE_H
+#define MENUCACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Manifest over the downloaded menu files in one directory, recording when
+// each was fetched, its content hash, and when it was last used. Menus
+// fetched within the time-to-live are served from disk without running
+// menu.py, and the files persist across sessions; when the directory
+// grows past its size limit, the least recently used files are deleted.
+// The manifest is a tab-separated file next to the menus, rewritten when
+// a menu is recorded or evicted and on exit; use times only change it in
+// memory until then.
+class MenuCache {
+private:
+    struct Entry {
+        std::int64_t fetchedAt = 0;
+        std::uint64_t hash = 0;
+        std::uintmax_t size = 0;
+        std::int64_t lastUsed = 0;
+        // Modification time when the hash was taken; while it and the size
+        // are unchanged the file is assumed unchanged too.
+        std::int64_t modifiedAt = 0;
+    };
+
+    std::string directory;
+    std::string manifestPath;
+    std::int64_t ttlSeconds;
+    std::uintmax_t maxBytes;
+    std::map<std::string, Entry> entries;
+    bool loaded;
+    bool dirty;
+    std::mutex cacheMutex;
+
+    // Reads the manifest once; unreadable lines are skipped.
+    void load();
+
+    // Writes the manifest to a temporary file and renames it into place.
+    void save();
+
+    // Hashes a file's bytes with 64-bit FNV-1a; false if it cannot be read.
+    static bool hashFile(const std::string& path, std::uint64_t& hash,
+                         std::uintmax_t& size);
+
+    // Records a file on disk, fetched at fetchedAt; false if it is missing.
+    bool recordLocked(const std::string& name, std::int64_t fetchedAt);
+
+    // Deletes least recently used files until the directory fits in
+    // maxBytes, never deleting keep.
+    void evictLocked(const std::string& keep);
+
+public:
+    // Default time-to-live and size limit.
+    static constexpr int DEFAULT_TTL_HOURS = 12;
+    static constexpr int DEFAULT_MAX_MB = 64;
+
+    // Attaches to the menus directory; the manifest is read on first use.
+    explicit MenuCache(const std::string& menuDirectory = "../data/menus");
+
+    // Writes out use times not yet saved.
+    ~MenuCache();
+
+    MenuCache(const MenuCache&) = delete;
+    MenuCache& operator=(const MenuCache&) = delete;
+
+    // Sets the time-to-live and size limit, evicting if needed.
+    void configure(std::int64_t ttl, std::uintmax_t bytes);
+
+    // True if the menu file exists, still matches its recorded hash, and
+    // was fetched within the time-to-live; marks it used. The file is only
+    // re-hashed when its size or modification time changed. Files written
+    // outside the manifest (menu.py extracts a whole week at once) are
+    // adopted with their modification time as the fetch time.
+    bool fresh(const std::string& name);
+
+    // True if the manifest or the directory already has the file, so a
+    // fetch must replace it rather than reuse it.
+    bool known(const std::string& name);
+
+    // Records a file menu.py just fetched, then evicts if over the limit;
+    // false if the file is missing.
+    bool record(const std::string& name);
+};
+
+#endif
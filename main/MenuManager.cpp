@@ -1,14 +1,22 @@
 #include "MenuManager.h"
 #include "UIUtils.h"
+#include "ThreadPool.h"
 #include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <ctime>
 #include <sstream>
 #include <map>
+#include <set>
+#include <cctype>
 #include <cmath>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <thread>
 
 using namespace std;
 
@@ -20,22 +28,62 @@ static string trim(const string& str) {
     return str.substr(first, last - first + 1);
 }
 
+// Reads an "icons" list that starts on line, either inline ("icons": ["VG"])
+// or one quoted entry per line up to the closing bracket.
+static void readIcons(istream& file, string line, vector<string>& icons) {
+    size_t open = line.find('[');
+    string text = line.substr(open + 1);
+    while (text.find(']') == string::npos && getline(file, line)) {
+        text += line;
+    }
+    text = text.substr(0, text.find(']'));
+
+    size_t start = text.find('"');
+    while (start != string::npos) {
+        size_t end = text.find('"', start + 1);
+        if (end == string::npos) break;
+        icons.push_back(text.substr(start + 1, end - start - 1));
+        start = text.find('"', end + 1);
+    }
+}
+
+// Orders items by station, then alphabetically within each station.
+static bool byStationAndName(const FoodItem& a, const FoodItem& b) {
+    if (a.station != b.station) {
+        return a.station < b.station;
+    }
+    return a.name < b.name;
+}
+
+static string toLower(string text) {
+    for (char& c : text) {
+        c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
 // Constructs a menu manager; menus are loaded on demand from JSON files.
 MenuManager::MenuManager(const string& filepath) {
     (void)filepath;
+    // With fewer cores than meals, the extra interpreters would only
+    // compete for CPU while starting, so meals share workers.
+    unsigned workerCount = min(3u, max(1u, thread::hardware_concurrency()));
+    for (unsigned i = 0; i < workerCount; i++) {
+        solverWorkers.emplace_back(new SolverWorker());
+    }
+    planCache.configure(planOptions.planCachePath, planOptions.planCacheEntries);
+    stationRules = loadStationRules(planOptions.stationRulesPath);
 }
 
-// Parses a menu JSON file into a list of FoodItem records.
-vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
+// Parses menu JSON, one field per line as menu.py writes it, into a list
+// of FoodItem records.
+vector<FoodItem> MenuManager::parseMenu(istream& file, bool sortItems) {
     vector<FoodItem> menu;
-    ifstream file(filename);
-
-    if (!file.is_open()) {
-        return menu;
-    }
-
     string line;
     string currentStation;
+    // Index of the item the lines being read belong to, or -1 when that
+    // item was skipped.
+    int lastItem = -1;
 
     // Skip the opening brace of the top-level JSON object.
     getline(file, line);
@@ -48,7 +96,13 @@ vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
             size_t end = line.find("\"", start);
             string possibleStation = line.substr(start, end - start);
 
-            if (possibleStation != "icons" && possibleStation != "serving_size") {
+            if (possibleStation == "icons") {
+                vector<string> icons;
+                readIcons(file, line, icons);
+                if (lastItem >= 0) {
+                    menu[lastItem].icons = icons;
+                }
+            } else if (possibleStation != "serving_size") {
                 currentStation = possibleStation;
             }
             continue;
@@ -56,6 +110,7 @@ vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
 
         // Detect the start of a food item by looking for its "name" field.
         if (line.find("\"name\"") != string::npos) {
+            lastItem = -1;
             FoodItem item;
             item.station = currentStation;
 
@@ -66,58 +121,47 @@ vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
                 start = line.find("\"", start) + 1;
                 item.name = line.substr(start, end - start);
 
-                // Skip ingredients line.
+                // Read the ingredients line.
                 getline(file, line);
+                if (line.find("\"ingredients\"") != string::npos) {
+                    size_t valueStart = line.find("\"", line.find(":") + 1);
+                    size_t valueEnd = line.find_last_of("\"");
+                    if (valueStart != string::npos && valueEnd > valueStart) {
+                        item.ingredients = line.substr(valueStart + 1, valueEnd - valueStart - 1);
+                    }
+                }
 
                 // Skip "nutrition": { line.
                 getline(file, line);
 
-                // Parse calories.
-                getline(file, line);
-                start = line.find(":") + 1;
-                string calStr = line.substr(start);
-                size_t commaPos = calStr.find(",");
-                if (commaPos != string::npos) {
-                    calStr = calStr.substr(0, commaPos);
-                }
-                calStr = trim(calStr);
-                item.calories = static_cast<int>(stod(calStr));
-
-                // Parse g_fat.
-                getline(file, line);
-                start = line.find(":") + 1;
-                string fatStr = line.substr(start);
-                commaPos = fatStr.find(",");
-                if (commaPos != string::npos) {
-                    fatStr = fatStr.substr(0, commaPos);
-                }
-                fatStr = trim(fatStr);
-                item.fats = stod(fatStr);
+                // Parse one "key": value line per nutrient up to the closing
+                // brace. The four macros are required; other nutrients count
+                // as zero when missing or null.
+                bool found[NUTRIENT_COUNT] = {};
+                while (getline(file, line) && line.find("}") == string::npos) {
+                    size_t keyStart = line.find("\"") + 1;
+                    size_t keyEnd = line.find("\"", keyStart);
+                    string key = line.substr(keyStart, keyEnd - keyStart);
+
+                    string valueStr = line.substr(line.find(":") + 1);
+                    size_t commaPos = valueStr.find(",");
+                    if (commaPos != string::npos) {
+                        valueStr = valueStr.substr(0, commaPos);
+                    }
+                    valueStr = trim(valueStr);
 
-                // Parse g_carbs.
-                getline(file, line);
-                start = line.find(":") + 1;
-                string carbStr = line.substr(start);
-                commaPos = carbStr.find(",");
-                if (commaPos != string::npos) {
-                    carbStr = carbStr.substr(0, commaPos);
+                    for (size_t i = 0; i < NUTRIENT_COUNT; i++) {
+                        if (key == NUTRIENT_INFO[i].key && valueStr != "null") {
+                            item.nutrients[i] = stod(valueStr);
+                            found[i] = true;
+                        }
+                    }
                 }
-                carbStr = trim(carbStr);
-                item.carbs = stod(carbStr);
-
-                // Parse g_protein.
-                getline(file, line);
-                start = line.find(":") + 1;
-                string proteinStr = line.substr(start);
-                commaPos = proteinStr.find(",");
-                if (commaPos != string::npos) {
-                    proteinStr = proteinStr.substr(0, commaPos);
+                for (int i = Nutrient::Calories; i <= Nutrient::Fats; i++) {
+                    if (!found[i]) {
+                        throw runtime_error(string("missing ") + NUTRIENT_INFO[i].key);
+                    }
                 }
-                proteinStr = trim(proteinStr);
-                item.protein = stod(proteinStr);
-
-                // Skip closing brace of the nutrition object.
-                getline(file, line);
 
                 // Parse serving size block if present.
                 getline(file, line);
@@ -126,7 +170,7 @@ vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
                     getline(file, line);
                     start = line.find(":") + 1;
                     string amountStr = line.substr(start);
-                    commaPos = amountStr.find(",");
+                    size_t commaPos = amountStr.find(",");
                     if (commaPos != string::npos) {
                         amountStr = amountStr.substr(0, commaPos);
                     }
@@ -163,9 +207,13 @@ vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
                 } else {
                     item.servingAmount = "1";
                     item.servingUnit = "serving";
+                    if (line.find("\"icons\"") != string::npos) {
+                        readIcons(file, line, item.icons);
+                    }
                 }
 
                 menu.push_back(item);
+                lastItem = static_cast<int>(menu.size()) - 1;
             } catch (const exception& e) {
 #ifdef DEBUG
                 cerr << "Error parsing item '" << item.name
@@ -176,24 +224,182 @@ vector<FoodItem> MenuManager::loadMenuFromFile(const string& filename) {
         }
     }
 
-    file.close();
-
     // Sort items by station, then alphabetically within each station.
-    sort(menu.begin(), menu.end(), [](const FoodItem& a, const FoodItem& b) {
-        if (a.station != b.station) {
-            return a.station < b.station;
-        }
-        return a.name < b.name;
-    });
+    if (sortItems) {
+        sort(menu.begin(), menu.end(), byStationAndName);
+    }
 
     return menu;
 }
 
-// Returns the per-meal menu for a given date using stored JSON files.
+// Breakfast, lunch, and dinner take the workers in turn, wrapping when
+// there are fewer workers than meals.
+SolverWorker& MenuManager::solverWorkerFor(const string& mealType) {
+    size_t slot = mealType == "lunch" ? 1 : mealType == "dinner" ? 2 : 0;
+    return *solverWorkers[slot % solverWorkers.size()];
+}
+
+// Replaces the settings used by generateMealPlan.
+void MenuManager::setPlanOptions(const PlanOptions& options) {
+    planOptions = options;
+    planCache.configure(planOptions.planCachePath,
+                        planOptions.planCachePath.empty() ? 0 : planOptions.planCacheEntries);
+    stationRules = loadStationRules(planOptions.stationRulesPath);
+}
+
+// Returns the settings used by generateMealPlan.
+const MenuManager::PlanOptions& MenuManager::getPlanOptions() const {
+    return planOptions;
+}
+
+// Macro grams follow from the calorie split at 4 kcal/g for protein and
+// carbs and 9 kcal/g for fat.
+Nutrients MenuManager::dailyGoals(const User& user) {
+    Nutrients goals{};
+    goals[Nutrient::Calories] = user.calorieGoal;
+    goals[Nutrient::Protein]  = (user.calorieGoal * user.macroRatio.protein) / 4.0;
+    goals[Nutrient::Carbs]    = (user.calorieGoal * user.macroRatio.carbs)   / 4.0;
+    goals[Nutrient::Fats]     = (user.calorieGoal * user.macroRatio.fats)    / 9.0;
+    goals[Nutrient::Fiber]    = user.fiberGoal;
+    goals[Nutrient::Sugar]    = user.sugarGoal;
+    goals[Nutrient::Sodium]   = user.sodiumGoal;
+    return goals;
+}
+
+// Returns the persistent plan cache's counters.
+PlanCache::Stats MenuManager::getPlanCacheStats() const {
+    return planCache.stats();
+}
+
+// Each "[meal ...]" line starts the rules for those meal types; the lines
+// after it add "exact NAME" or "contains TEXT" rules. Blank lines and
+// '#' comments are skipped.
+map<string, MenuManager::StationRules> MenuManager::loadStationRules(const string& filepath) {
+    map<string, StationRules> rules;
+    ifstream file(filepath);
+    if (!file.is_open()) {
+#ifdef DEBUG
+        cerr << "No station rules at " << filepath << "; menus keep every station" << endl;
+#endif
+        return rules;
+    }
+
+    vector<string> meals;
+    string line;
+    while (getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            meals.clear();
+            istringstream names(line.substr(1, line.size() - 2));
+            string meal;
+            while (names >> meal) {
+                meals.push_back(meal);
+                rules[meal];
+            }
+            continue;
+        }
+
+        size_t space = line.find(' ');
+        string kind = line.substr(0, space);
+        string value = space == string::npos ? "" : trim(line.substr(space + 1));
+        if (value.empty() || (kind != "exact" && kind != "contains")) {
+            continue;
+        }
+        for (const string& meal : meals) {
+            (kind == "exact" ? rules[meal].exact : rules[meal].contains).push_back(value);
+        }
+    }
+    return rules;
+}
+
+// Mirrors menu.py's simplify_menu: stations are matched on their trimmed
+// names, and an item name seen at any earlier station is dropped.
+vector<FoodItem> MenuManager::simplifyMenu(const vector<FoodItem>& menu,
+                                           const StationRules& rules) {
+    vector<FoodItem> simplified;
+    set<string> seenNames;
+    for (const auto& item : menu) {
+        string station = trim(item.station);
+        bool dropped = find(rules.exact.begin(), rules.exact.end(), station) != rules.exact.end();
+        for (size_t i = 0; i < rules.contains.size() && !dropped; i++) {
+            dropped = station.find(rules.contains[i]) != string::npos;
+        }
+        if (dropped) {
+            continue;
+        }
+
+        // Items without a name are kept rather than dropped as unknowns.
+        string name = trim(item.name);
+        if (!name.empty() && !seenNames.insert(toLower(name)).second) {
+            continue;
+        }
+        simplified.push_back(item);
+    }
+
+    sort(simplified.begin(), simplified.end(), byStationAndName);
+    return simplified;
+}
+
+// Looks the filter up in an inverted index over the menu's icons and
+// ingredients.
+vector<FoodItem> MenuManager::filterMenu(const vector<FoodItem>& menu, const string& dietFilter) {
+    DietFilter filter = DietIndex::parseFilter(dietFilter);
+    if (filter.empty()) {
+        return menu;
+    }
+    vector<FoodItem> kept;
+    for (int j : DietIndex(menu).matching(filter)) {
+        kept.push_back(menu[j]);
+    }
+    return kept;
+}
+
+// Returns the per-meal menu for a given date, sorted for display.
 vector<FoodItem> MenuManager::getDailyMenu(const string& mealType,
                                            const string& date) {
-    string filepath = "../data/menus/" + mealType + "-" + date + ".json";
-    return loadMenuFromFile(filepath);
+    vector<FoodItem> menu = loadMenu(mealType, date);
+    sort(menu.begin(), menu.end(), byStationAndName);
+    return menu;
+}
+
+// Native ingestion keeps every day of a fetched week, so the rest of the
+// week needs no further request; otherwise menu.py saves the menu file.
+vector<FoodItem> MenuManager::loadMenu(const string& mealType, const string& date) {
+    if (!planOptions.nativeIngestion) {
+        UIUtils::fetchMenuFor(date, mealType);
+        ifstream file("../data/menus/" + mealType + "-" + date + ".json");
+        if (!file.is_open()) {
+            return {};
+        }
+        return parseMenu(file, false);
+    }
+
+    auto key = make_pair(mealType, date);
+    {
+        lock_guard<mutex> lock(ingestMutex);
+        auto cached = ingestedMenus.find(key);
+        if (cached != ingestedMenus.end()) {
+            return cached->second;
+        }
+    }
+
+    // Fetch without the lock so meals planned together download their
+    // weeks in parallel.
+    NutrisliceClient client(planOptions.nutrislice);
+    NutrisliceClient::WeekMenus week;
+    string error;
+    if (!client.fetchWeek(mealType, date, week, error)) {
+        cerr << "Error: cannot fetch " << mealType << " for " << date << ": " << error << endl;
+        return {};
+    }
+    lock_guard<mutex> lock(ingestMutex);
+    for (auto& day : week) {
+        ingestedMenus[make_pair(mealType, day.first)] = move(day.second);
+    }
+    return ingestedMenus[key];
 }
 
 // Prints a simple numbered list of all items in a menu.
@@ -246,10 +452,10 @@ void MenuManager::displayMenuTable(const vector<FoodItem>& menu) {
             amount = 1.0;
         }
 
-        double calPerUnit     = static_cast<double>(item.calories) / amount;
-        double proteinPerUnit = item.protein / amount;
-        double carbsPerUnit   = item.carbs   / amount;
-        double fatsPerUnit    = item.fats    / amount;
+        double calPerUnit     = item.nutrients[Nutrient::Calories] / amount;
+        double proteinPerUnit = item.nutrients[Nutrient::Protein]  / amount;
+        double carbsPerUnit   = item.nutrients[Nutrient::Carbs]    / amount;
+        double fatsPerUnit    = item.nutrients[Nutrient::Fats]     / amount;
 
         std::ostringstream proteinDisplay, carbsDisplay, fatsDisplay;
         proteinDisplay << fixed << setprecision(1) << proteinPerUnit << "g";
@@ -271,27 +477,112 @@ void MenuManager::displayMenuTable(const vector<FoodItem>& menu) {
     }
 }
 
-// Generates a meal plan for today using Nutrislice menus and solver.py.
-MenuManager::MealPlanResult MenuManager::generateMealPlan(const User& user) {
-    MealPlanResult result{};
+string MenuManager::planCacheKey(uint64_t menuHash, const MacroVector& goal,
+                                 SolverMode mode) const {
+    static const char* const MODE_NAMES[] = {"python", "portfolio", "decomposed"};
+    string key = PlanCache::makeKey(menuHash, goal, planOptions.cacheCalorieStep,
+                                    planOptions.cacheGramStep);
+    key += '/';
+    key += MODE_NAMES[static_cast<int>(mode)];
+    if (mode == SolverMode::Python) {
+        key += '-' + planOptions.pythonFormulation;
+    } else {
+        const PlanSettings& engine = planOptions.engine;
+        ostringstream limits;
+        limits << '-' << planOptions.alternatives << 'd' << planOptions.minItemDifference
+               << '/' << engine.maxItems << 'i' << engine.maxLevel << 'l'
+               << engine.servingStep << 's';
+        key += limits.str();
+    }
+    key += '/' + to_string(planOptions.deadlineMs) + "ms";
+    return key;
+}
 
-    time_t now = time(nullptr);
-    tm* ltm = localtime(&now);
-    char dateBuf[11];
-    strftime(dateBuf, sizeof(dateBuf), "%Y-%m-%d", ltm);
-    result.dateStr = dateBuf;
+// Cached plans hold (menu index, servings) pairs; indices past the end
+// of the menu are skipped. Nothing bounds the re-scored plan any more, so
+// it is reported as feasible with the whole objective as its gap.
+bool MenuManager::planFromCache(const vector<FoodItem>& menu, const string& key,
+                                const MacroVector& goal,
+                                vector<vector<MealPlanResult::PlannedItem>>& alternatives,
+                                PlanSolution& solution,
+                                MealPlanResult::MealSolveInfo& info) {
+    PlanCache::Entry cached;
+    if (!planCache.lookup(key, cached)) {
+        return false;
+    }
 
-    result.calorieGoal = user.calorieGoal;
-    result.proteinGoal = (user.calorieGoal * user.macroRatio.protein) / 4.0;
-    result.carbsGoal   = (user.calorieGoal * user.macroRatio.carbs)   / 4.0;
-    result.fatsGoal    = (user.calorieGoal * user.macroRatio.fats)    / 9.0;
+    PlanSettings settings = planOptions.engine;
+    solution.levels.assign(menu.size(), 0);
+    MacroVector residual = MacroVector{} - goal;
+    for (const auto& plan : cached.plans) {
+        vector<MealPlanResult::PlannedItem> planned;
+        for (const auto& pick : plan) {
+            if (pick.first < 0 || pick.first >= static_cast<int>(menu.size())) continue;
+            planned.push_back({menu[pick.first], pick.second});
+            if (alternatives.empty()) {
+                solution.levels[pick.first] =
+                    static_cast<int>(lround(pick.second / settings.servingStep));
+                residual.addScaled(planVector(menu[pick.first].nutrients), pick.second);
+            }
+        }
+        alternatives.push_back(planned);
+    }
+    solution.objective = residual.squaredNorm();
+    info.objective = solution.objective;
+    info.gap       = solution.objective;
+    info.optimal   = false;
+    info.status    = SolveStatus::Feasible;
+    info.itemsBefore = info.itemsAfter = static_cast<int>(menu.size());
+    return true;
+}
 
-    result.loggedTotals = calculateDailyTotals(user, result.dateStr);
+// Items are matched back to menu indices by name, which the simplified
+// menu keeps unique.
+void MenuManager::storeInCache(const vector<FoodItem>& menu, const string& key,
+                               const vector<vector<MealPlanResult::PlannedItem>>& alternatives,
+                               const MealPlanResult::MealSolveInfo& info) {
+    map<string, int> indexOf;
+    for (size_t j = 0; j < menu.size(); j++) {
+        indexOf.insert({menu[j].name, static_cast<int>(j)});
+    }
+    PlanCache::Entry entry;
+    entry.objective = info.objective;
+    entry.gap       = info.gap;
+    entry.optimal   = info.optimal;
+    for (const auto& plan : alternatives) {
+        vector<pair<int, double>> picks;
+        for (const auto& item : plan) {
+            auto found = indexOf.find(item.item.name);
+            if (found != indexOf.end()) {
+                picks.push_back({found->second, item.servings});
+            }
+        }
+        entry.plans.push_back(picks);
+    }
+    planCache.store(key, entry);
+}
+
+// Loads the meal's menu in menu order and simplifies it in memory, so no
+// Python process runs for this step.
+vector<FoodItem> MenuManager::loadSimplifiedMenu(const string& mealType,
+                                                 const string& date) {
+    vector<FoodItem> menu = loadMenu(mealType, date);
+    if (menu.empty()) {
+        cerr << "Error: no " << mealType << " menu for " << date << endl;
+        return {};
+    }
+
+    auto rules = stationRules.find(mealType);
+    return simplifyMenu(menu, rules != stationRules.end() ? rules->second : StationRules());
+}
 
-    double remainingCalories = result.calorieGoal - result.loggedTotals.calories;
-    double remainingProtein  = result.proteinGoal - result.loggedTotals.protein;
-    double remainingCarbs    = result.carbsGoal   - result.loggedTotals.carbs;
-    double remainingFats     = result.fatsGoal    - result.loggedTotals.fats;
+// Splits what the user has left of each daily goal across the meals not
+// yet logged, weighted 30/40/30 for breakfast, lunch, and dinner.
+map<string, MenuManager::MealTargets> MenuManager::mealBudgets(
+    const User& user, MealPlanResult& result) {
+    result.goals = dailyGoals(user);
+    result.loggedTotals = calculateDailyTotals(user, result.dateStr);
+    Nutrients remaining = result.goals - result.loggedTotals;
 
     bool bLogged = false, lLogged = false, dLogged = false;
     auto dateIt = user.loggedMeals.find(result.dateStr);
@@ -309,14 +600,7 @@ MenuManager::MealPlanResult MenuManager::generateMealPlan(const User& user) {
     result.mealLogged["lunch"]     = lLogged;
     result.mealLogged["dinner"]    = dLogged;
 
-    struct MealTargets {
-        double calories;
-        double protein;
-        double carbs;
-        double fats;
-    };
-
-    map<string, MealTargets> mealBudgets;
+    map<string, MealTargets> budgets;
 
     double bWeight = 0.3;
     double lWeight = 0.4;
@@ -328,135 +612,845 @@ MenuManager::MealPlanResult MenuManager::generateMealPlan(const User& user) {
     if (!dLogged) totalWeight += dWeight;
 
     if (totalWeight <= 0.0) {
+        return budgets;
+    }
+
+    // Splits what is left of each nutrient by the meal's weight.
+    auto budget = [&](double weight) {
+        MealTargets targets = remaining * (weight / totalWeight);
+        for (double& amount : targets) {
+            amount = max(amount, 0.0);
+        }
+        return targets;
+    };
+
+    if (!bLogged) budgets["breakfast"] = budget(bWeight);
+    if (!lLogged) budgets["lunch"]     = budget(lWeight);
+    if (!dLogged) budgets["dinner"]    = budget(dWeight);
+
+    return budgets;
+}
+
+// Generates a meal plan for today using Nutrislice menus and the configured solver.
+// Each unlogged meal runs through the same pipeline (fetch, simplify,
+// solve, match) on its own worker, so the meals overlap and the plan takes
+// about as long as the slowest meal rather than all three in a row.
+MenuManager::MealPlanResult MenuManager::generateMealPlan(const User& user) {
+    MealPlanResult result{};
+
+    time_t now = time(nullptr);
+    tm* ltm = localtime(&now);
+    char dateBuf[11];
+    strftime(dateBuf, sizeof(dateBuf), "%Y-%m-%d", ltm);
+    result.dateStr = dateBuf;
+
+    map<string, MealTargets> budgets = mealBudgets(user, result);
+    if (budgets.empty()) {
         return result;
     }
+    DietFilter filter = DietIndex::parseFilter(user.dietFilter);
+
+    // What one meal's pipeline hands back to be merged into the result.
+    struct MealOutcome {
+        vector<vector<MealPlanResult::PlannedItem>> alternatives;
+        MealPlanResult::MealSolveInfo info;
+        vector<FoodItem> menu;
+        vector<MacroVector> items;
+        vector<bool> excluded;
+    };
 
-    auto clamp = [](double x) { return x < 0.0 ? 0.0 : x; };
-
-    if (!bLogged) {
-        double ratio = bWeight / totalWeight;
-        mealBudgets["breakfast"] = {
-            clamp(remainingCalories * ratio),
-            clamp(remainingProtein  * ratio),
-            clamp(remainingCarbs    * ratio),
-            clamp(remainingFats     * ratio)
-        };
-    }
-    if (!lLogged) {
-        double ratio = lWeight / totalWeight;
-        mealBudgets["lunch"] = {
-            clamp(remainingCalories * ratio),
-            clamp(remainingProtein  * ratio),
-            clamp(remainingCarbs    * ratio),
-            clamp(remainingFats     * ratio)
-        };
-    }
-    if (!dLogged) {
-        double ratio = dWeight / totalWeight;
-        mealBudgets["dinner"] = {
-            clamp(remainingCalories * ratio),
-            clamp(remainingProtein  * ratio),
-            clamp(remainingCarbs    * ratio),
-            clamp(remainingFats     * ratio)
-        };
-    }
-
-    // For each unlogged meal, call menu.py and solver.py to build a plan.
-    for (const auto& budgetPair : mealBudgets) {
-        const string& mealType = budgetPair.first;
-        const MealTargets& targets = budgetPair.second;
-
-        UIUtils::fetchMenuFor(result.dateStr, mealType);
-
-        string baseFilename       = mealType + "-" + result.dateStr + ".json";
-        string simplifiedFilename = "simplified-" + baseFilename;
-        string simplifiedPath     = "../data/menus/" + simplifiedFilename;
-        string planPath           = "../data/menus/plan-" + mealType + "-" + result.dateStr + ".txt";
+    // One meal, start to finish, on the calling worker thread.
+    auto planMeal = [this, &user, &filter, &result](const string& mealType,
+                                                    const MealTargets& targets) {
+        MealOutcome outcome;
 
-#ifndef _WIN32
-        const string PY = "../.venv/bin/python";
-        string simplifyCmd =
-            PY + " -c \"from menu import simplify_menu_file; "
-            "simplify_menu_file('" + baseFilename + "')\""
-            " > /dev/null 2>&1";
-#else
-        string simplifyCmd =
-            "python -c \"from menu import simplify_menu_file; "
-            "simplify_menu_file('" + baseFilename + "')\""
-            " > NUL 2>&1";
-#endif
+        // Fetch and simplify: menu.py or native ingestion, then the
+        // station rules and duplicate removal in memory.
+        vector<FoodItem> menu = loadSimplifiedMenu(mealType, result.dateStr);
+        if (menu.empty()) {
+            return outcome;
+        }
 
-        int simplifyStatus = std::system(simplifyCmd.c_str());
-        if (simplifyStatus != 0) {
-            cerr << "Error: simplify_menu_file failed for "
-                 << baseFilename
-                 << " with status " << simplifyStatus << endl;
-            continue;
+        // The menu model is cached by content, so every user planning
+        // against the same menu reuses its Gram matrix and presolve
+        // groupings; its content hash also versions the warm starts.
+        auto modelStart = chrono::steady_clock::now();
+        vector<MacroVector> items;
+        for (const auto& item : menu) {
+            items.push_back(planVector(item.nutrients));
+        }
+        shared_ptr<const MenuModel> model = engine.prepareMenu(items);
+        MacroVector goal = planVector(targets);
+        double modelSeconds = chrono::duration<double>(
+            chrono::steady_clock::now() - modelStart).count();
+
+        // Items the user's diet filter rules out never reach the solver.
+        vector<bool> excluded = DietIndex(menu).excluded(filter);
+
+        // Reuse the previous plan if the targets have not moved, repair it
+        // if they moved a little, and recompute otherwise.
+        WarmKey key(user.uid, mealType, model->version);
+        WarmStart warm;
+        bool haveWarm = false;
+        {
+            lock_guard<mutex> lock(warmMutex);
+            auto found = warmStarts.find(key);
+            if (found != warmStarts.end()) {
+                warm = found->second;
+                haveWarm = true;
+            }
+        }
+        double goalChange = numeric_limits<double>::infinity();
+        if (haveWarm && warm.solverMode == planOptions.solverMode && warm.excluded == excluded) {
+            double diff = 0.0, base = 0.0;
+            for (int i = 0; i < MACRO_COUNT; i++) {
+                diff += (goal[i] - warm.goal[i]) * (goal[i] - warm.goal[i]);
+                base += warm.goal[i] * warm.goal[i];
+            }
+            goalChange = sqrt(diff / max(base, 1e-12));
+        }
+
+        // Persistent cache key: the simplified menu's content and diet
+        // exclusions, the quantized targets, and the solver settings.
+        bool cacheEnabled = !planOptions.planCachePath.empty();
+        string cacheKey = planCacheKey(
+            PlanCache::hashExclusions(PlanCache::hashMenu(menu), excluded), goal,
+            planOptions.solverMode);
+
+        // Solve. Meals on separate solver.py workers solve at the same
+        // time; native solves take turns, as one already fills the
+        // engine's pool and racing three would eat into every deadline.
+        vector<vector<MealPlanResult::PlannedItem>>& alternatives = outcome.alternatives;
+        MealPlanResult::MealSolveInfo& info = outcome.info;
+        PlanSolution solution;
+        if (goalChange <= 1e-9) {
+            alternatives = warm.alternatives;
+            info = warm.info;
+            info.reuse = PlanReuse::Reused;
+            info.buildSeconds = info.solveSeconds = 0.0;
+            info.nodes = 0;
+        } else if (cacheEnabled && planFromCache(menu, cacheKey, goal, alternatives, solution, info)) {
+            info.reuse = PlanReuse::Cached;
+        } else if (planOptions.solverMode != SolverMode::Python) {
+            const PlanSolution* warmStart = nullptr;
+            if (goalChange <= planOptions.repairTolerance) {
+                warmStart = &warm.solution;
+            }
+            lock_guard<mutex> lock(engineSolveMutex);
+            alternatives = planWithEngine(menu, *model, goal, warmStart, solution, info,
+                                          false, excluded);
+            info.reuse = warmStart ? PlanReuse::Repaired : PlanReuse::Recomputed;
+            info.buildSeconds += modelSeconds;
+        } else {
+            alternatives.push_back(
+                planWithPython(menu, items, goal, excluded, mealType, result.dateStr, info));
+        }
+
+        // Match: persist fresh solves and remember the plan for the next
+        // re-plan of this meal.
+        bool planned = !alternatives.empty() && !alternatives.front().empty();
+        if (cacheEnabled && planned
+            && (info.reuse == PlanReuse::Recomputed || info.reuse == PlanReuse::Repaired)) {
+            storeInCache(menu, cacheKey, alternatives, info);
+        }
+
+        // Keep only the newest menu version per user and meal.
+        if (info.reuse != PlanReuse::Reused && planned) {
+            lock_guard<mutex> lock(warmMutex);
+            for (auto it = warmStarts.begin(); it != warmStarts.end();) {
+                if (get<0>(it->first) == user.uid && get<1>(it->first) == mealType) {
+                    it = warmStarts.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            warmStarts[key] = WarmStart{planOptions.solverMode, goal, excluded, solution,
+                                        alternatives, info};
+        }
+
+        outcome.menu.swap(menu);
+        outcome.items.swap(items);
+        outcome.excluded.swap(excluded);
+        return outcome;
+    };
+
+    map<string, future<MealOutcome>> pending;
+    {
+        ThreadPool pipeline(static_cast<unsigned>(budgets.size()));
+        for (const auto& budgetPair : budgets) {
+            const string& mealType = budgetPair.first;
+            const MealTargets& targets = budgetPair.second;
+            pending[mealType] = pipeline.submit([&planMeal, &mealType, &targets]() {
+                return planMeal(mealType, targets);
+            });
+        }
+
+        for (auto& task : pending) {
+            const string& mealType = task.first;
+            MealOutcome outcome = task.second.get();
+            vector<MealPlanResult::PlannedItem> planned;
+            if (!outcome.alternatives.empty()) {
+                planned = outcome.alternatives.front();
+            }
+
+            if (!planned.empty()) {
+                result.selectedMeals[mealType] = planned;
+                result.alternativeMeals[mealType] = outcome.alternatives;
+                result.menus[mealType] = MealPlanResult::MealMenu{
+                    budgets[mealType], outcome.menu, MacroIndex(outcome.items),
+                    outcome.excluded};
+            }
+            if (!planned.empty() || outcome.info.status == SolveStatus::Failed) {
+                result.solveInfo[mealType] = outcome.info;
+            }
+        }
+    }
+
+    return result;
+}
+
+// Marks the menu items that cannot be swapped in: those already part of
+// the meal and those the diet filter rules out.
+static vector<bool> unavailable(const MenuManager::MealPlanResult::MealMenu& menu,
+                                const vector<MenuManager::MealPlanResult::PlannedItem>& meal) {
+    vector<bool> skip(menu.items.size(), false);
+    for (size_t j = 0; j < menu.items.size(); j++) {
+        skip[j] = j < menu.excluded.size() && menu.excluded[j];
+        for (const auto& planned : meal) {
+            if (planned.item.name == menu.items[j].name) {
+                skip[j] = true;
+                break;
+            }
+        }
+    }
+    return skip;
+}
+
+// Nearest neighbors of the item's per-serving vector in the menu's index.
+vector<MenuManager::SwapSuggestion> MenuManager::similarItems(
+    const MealPlanResult& plan, const string& mealType,
+    const vector<MealPlanResult::PlannedItem>& meal, size_t position, size_t count) const {
+    vector<SwapSuggestion> suggestions;
+    auto found = plan.menus.find(mealType);
+    if (found == plan.menus.end() || position >= meal.size()) {
+        return suggestions;
+    }
+    const MealPlanResult::MealMenu& menu = found->second;
+
+    MacroVector query = planVector(meal[position].item.nutrients);
+    for (const auto& near : menu.index.nearest(query, count, unavailable(menu, meal))) {
+        suggestions.push_back({menu.items[near.item], meal[position].servings, near.distance});
+    }
+    return suggestions;
+}
+
+// At s servings an item a leaves ||s a - r||^2 = s^2 ||a - r / s||^2 of the
+// gap r, so each serving level is one nearest-neighbor query for r / s.
+// An item among the count best overall is among the count best at its own
+// best level, so merging the per-level results is exact.
+vector<MenuManager::SwapSuggestion> MenuManager::gapFillers(
+    const MealPlanResult& plan, const string& mealType,
+    const vector<MealPlanResult::PlannedItem>& meal, size_t position, size_t count) const {
+    vector<SwapSuggestion> suggestions;
+    auto found = plan.menus.find(mealType);
+    if (found == plan.menus.end() || position >= meal.size()) {
+        return suggestions;
+    }
+    const MealPlanResult::MealMenu& menu = found->second;
+
+    MacroVector gap = planVector(menu.targets);
+    for (size_t k = 0; k < meal.size(); k++) {
+        if (k != position) {
+            gap.addScaled(planVector(meal[k].item.nutrients), -meal[k].servings);
+        }
+    }
+
+    vector<bool> skip = unavailable(menu, meal);
+    const PlanSettings& settings = planOptions.engine;
+    map<int, pair<double, double>> bestFit;  // item -> (error, servings)
+    for (int level = 1; level <= settings.maxLevel; level++) {
+        double servings = level * settings.servingStep;
+        for (const auto& near : menu.index.nearest(gap * (1.0 / servings), count, skip)) {
+            double error = servings * servings * near.distance;
+            auto it = bestFit.find(near.item);
+            if (it == bestFit.end() || error < it->second.first) {
+                bestFit[near.item] = {error, servings};
+            }
+        }
+    }
+
+    for (const auto& fit : bestFit) {
+        suggestions.push_back({menu.items[fit.first], fit.second.second, fit.second.first});
+    }
+    sort(suggestions.begin(), suggestions.end(),
+         [](const SwapSuggestion& a, const SwapSuggestion& b) { return a.distance < b.distance; });
+    if (suggestions.size() > count) {
+        suggestions.resize(count);
+    }
+    return suggestions;
+}
+
+// Loads each needed menu once, then solves every (user, meal) pair as its
+// own task. Tasks only read the shared menus and models; results are
+// collected on this thread in user order, so demand totals are stable.
+MenuManager::BatchPlanResult MenuManager::generateBatchPlans(
+    const vector<User>& users, const string& date, unsigned threadCount) {
+    BatchPlanResult batch;
+    batch.dateStr = date;
+
+    // Budgets first: they also tell which meals anyone still needs.
+    vector<map<string, MealTargets>> budgets;
+    for (const auto& user : users) {
+        MealPlanResult& result = batch.plans[user.uid];
+        result.dateStr = date;
+        budgets.push_back(mealBudgets(user, result));
+    }
+
+    struct LoadedMenu {
+        vector<FoodItem> items;
+        shared_ptr<const MenuModel> model;
+        DietIndex diet;
+        uint64_t hash = 0;
+    };
+    map<string, LoadedMenu> menus;
+    for (const auto& userBudgets : budgets) {
+        for (const auto& budgetPair : userBudgets) {
+            if (menus.count(budgetPair.first)) continue;
+            LoadedMenu& loaded = menus[budgetPair.first];
+            loaded.items = loadSimplifiedMenu(budgetPair.first, date);
+            vector<MacroVector> items;
+            for (const auto& item : loaded.items) {
+                items.push_back(planVector(item.nutrients));
+            }
+            loaded.model = engine.prepareMenu(items);
+            loaded.diet = DietIndex(loaded.items);
+            loaded.hash = PlanCache::hashMenu(loaded.items);
+        }
+    }
+
+    typedef pair<vector<vector<MealPlanResult::PlannedItem>>,
+                 MealPlanResult::MealSolveInfo> MealOutcome;
+    bool cacheEnabled = !planOptions.planCachePath.empty();
+
+    // One meal for one user, on the calling worker thread.
+    auto solveMeal = [this, cacheEnabled](const LoadedMenu& loaded, MacroVector goal,
+                                          const vector<bool>& excluded) {
+        MealOutcome outcome;
+        PlanSolution solution;
+        // Batches always solve natively.
+        string cacheKey = planCacheKey(PlanCache::hashExclusions(loaded.hash, excluded), goal,
+                                       planOptions.solverMode == SolverMode::Decomposed
+                                           ? SolverMode::Decomposed : SolverMode::Portfolio);
+        if (cacheEnabled && planFromCache(loaded.items, cacheKey, goal, outcome.first,
+                                          solution, outcome.second)) {
+            outcome.second.reuse = PlanReuse::Cached;
+            return outcome;
+        }
+        outcome.first = planWithEngine(loaded.items, *loaded.model, goal, nullptr,
+                                       solution, outcome.second, true, excluded);
+        outcome.second.reuse = PlanReuse::Recomputed;
+        if (cacheEnabled && !outcome.first.empty()) {
+            storeInCache(loaded.items, cacheKey, outcome.first, outcome.second);
+        }
+        return outcome;
+    };
+
+    struct MealTask {
+        size_t user;
+        string mealType;
+        future<MealOutcome> outcome;
+    };
+    vector<MealTask> tasks;
+    planCache.setDeferred(true);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    {
+        ThreadPool workers(threadCount);
+        for (size_t u = 0; u < users.size(); u++) {
+            DietFilter filter = DietIndex::parseFilter(users[u].dietFilter);
+            for (const auto& budgetPair : budgets[u]) {
+                const LoadedMenu& loaded = menus[budgetPair.first];
+                if (loaded.items.empty()) continue;
+
+                MacroVector goal = planVector(budgetPair.second);
+                vector<bool> excluded = loaded.diet.excluded(filter);
+                tasks.push_back({u, budgetPair.first,
+                                 workers.submit([&solveMeal, &loaded, goal, excluded]() {
+                    return solveMeal(loaded, goal, excluded);
+                })});
+            }
+        }
+
+        for (auto& task : tasks) {
+            auto outcome = task.outcome.get();
+            if (outcome.first.empty()) continue;
+
+            MealPlanResult& result = batch.plans[users[task.user].uid];
+            result.selectedMeals[task.mealType] = outcome.first.front();
+            result.alternativeMeals[task.mealType] = outcome.first;
+            result.solveInfo[task.mealType] = outcome.second;
+            for (const auto& item : outcome.first.front()) {
+                batch.demand[task.mealType][item.item.name] += item.servings;
+            }
+            batch.mealPlans++;
+            if (outcome.second.reuse == PlanReuse::Cached) {
+                batch.cachedPlans++;
+            }
+        }
+    }
+    batch.solveSeconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    planCache.setDeferred(false);
+    return batch;
+}
+
+// Returns the date days after date, both as "YYYY-MM-DD".
+static string addDays(const string& date, int days) {
+    tm day = {};
+    istringstream(date) >> get_time(&day, "%Y-%m-%d");
+    day.tm_mday += days;
+    day.tm_hour = 12;
+    day.tm_isdst = -1;
+    mktime(&day);
+    char dateBuf[11];
+    strftime(dateBuf, sizeof(dateBuf), "%Y-%m-%d", &day);
+    return dateBuf;
+}
+
+// Block coordinate descent over the meals of the date range, one meal per
+// block: the week's objective is the sum of the meals' squared errors, and
+// the variety limits couple meals only through which items they plan.
+// Every solve excludes the items the other meals' plans have used up, so
+// the plans stay within the limits after every step. Each pass can only
+// improve the week, but the result depends on the order meals claim items
+// and need not be the joint optimum.
+MenuManager::MultiDayPlanResult MenuManager::generateMultiDayPlan(
+    const User& user, const string& startDate, int dayCount) {
+    MultiDayPlanResult plan;
+
+    // Simplified menus by content hash, so repeated menus share a model.
+    struct LoadedMenu {
+        vector<FoodItem> items;
+        shared_ptr<const MenuModel> model;
+        vector<bool> dietExcluded;
+    };
+    map<uint64_t, LoadedMenu> menus;
+    DietFilter filter = DietIndex::parseFilter(user.dietFilter);
+
+    // One meal of one day and its current plan.
+    struct MealSlot {
+        int day;
+        string mealType;
+        const LoadedMenu* menu;
+        MacroVector goal;
+        PlanSolution solution;
+        vector<vector<MealPlanResult::PlannedItem>> alternatives;
+        MealPlanResult::MealSolveInfo info;
+    };
+    vector<MealSlot> slots;
+
+    const vector<string> mealOrder = {"breakfast", "lunch", "dinner"};
+    for (int d = 0; d < dayCount; d++) {
+        MealPlanResult day;
+        day.dateStr = addDays(startDate, d);
+        map<string, MealTargets> budgets = mealBudgets(user, day);
+        plan.days.push_back(day);
+
+        for (const string& mealType : mealOrder) {
+            auto budget = budgets.find(mealType);
+            if (budget == budgets.end()) continue;
+            vector<FoodItem> items = loadSimplifiedMenu(mealType, day.dateStr);
+            if (items.empty()) continue;
+
+            LoadedMenu& loaded = menus[PlanCache::hashMenu(items)];
+            if (!loaded.model) {
+                vector<MacroVector> vectors;
+                for (const auto& item : items) {
+                    vectors.push_back(planVector(item.nutrients));
+                }
+                loaded.items = items;
+                loaded.model = engine.prepareMenu(vectors);
+                loaded.dietExcluded = DietIndex(items).excluded(filter);
+            }
+            MealSlot slot;
+            slot.day = d;
+            slot.mealType = mealType;
+            slot.menu = &loaded;
+            slot.goal = planVector(budget->second);
+            slots.push_back(slot);
+        }
+    }
+
+    // Meals per day that plan each item, by item name.
+    map<string, map<int, int>> usage;
+    auto track = [&usage](const MealSlot& slot, int delta) {
+        if (slot.alternatives.empty()) return;
+        for (const auto& planned : slot.alternatives.front()) {
+            map<int, int>& days = usage[planned.item.name];
+            days[slot.day] += delta;
+            if (days[slot.day] == 0) days.erase(slot.day);
+        }
+    };
+
+    // An item is blocked on a day if its station is covered by the
+    // repetition limits and other days already use it up to the limit, or
+    // it appears on another day too close to this one.
+    const vector<string>& covered = planOptions.varietyStations;
+    auto blocked = [&](const FoodItem& item, int day) {
+        bool limited = covered.empty()
+            || any_of(covered.begin(), covered.end(), [&item](const string& station) {
+                   return item.station.find(station) != string::npos;
+               });
+        if (!limited) return false;
+        auto found = usage.find(item.name);
+        if (found == usage.end()) return false;
+        int otherDays = 0;
+        for (const auto& entry : found->second) {
+            if (entry.first == day) continue;
+            if (abs(entry.first - day) < planOptions.minRepeatGapDays) return true;
+            otherDays++;
+        }
+        return otherDays >= planOptions.maxItemDays;
+    };
+
+    // Re-solves one meal against the others' current plans, warm from its
+    // own plan if it has one; returns true if the plan improved.
+    auto solve = [&](MealSlot& slot) {
+        const vector<FoodItem>& items = slot.menu->items;
+        vector<bool> excluded(items.size(), false);
+        const vector<bool>& diet = slot.menu->dietExcluded;
+        for (size_t j = 0; j < items.size(); j++) {
+            excluded[j] = (j < diet.size() && diet[j]) || blocked(items[j], slot.day);
+        }
+
+        bool warm = !slot.alternatives.empty();
+        PlanSolution solution;
+        MealPlanResult::MealSolveInfo info;
+        vector<vector<MealPlanResult::PlannedItem>> alternatives = planWithEngine(
+            items, *slot.menu->model, slot.goal, warm ? &slot.solution : nullptr,
+            solution, info, false, excluded);
+        if (alternatives.empty()
+            || (warm && solution.objective >= slot.solution.objective - 1e-9)) {
+            return false;
+        }
+        info.reuse = warm ? PlanReuse::Repaired : PlanReuse::Recomputed;
+        slot.solution = solution;
+        slot.alternatives = alternatives;
+        slot.info = info;
+        return true;
+    };
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (auto& slot : slots) {
+        solve(slot);
+        track(slot, 1);
+    }
+    for (int pass = 0; pass < planOptions.varietyPasses; pass++) {
+        bool improved = false;
+        for (auto& slot : slots) {
+            track(slot, -1);
+            improved = solve(slot) || improved;
+            track(slot, 1);
+        }
+        plan.passes++;
+        if (!improved) break;
+    }
+    plan.solveSeconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (auto& slot : slots) {
+        if (slot.alternatives.empty()) continue;
+
+        // Alternatives were ranked before later meals were settled; keep
+        // the ones that still fit the limits next to the final plans.
+        track(slot, -1);
+        vector<vector<MealPlanResult::PlannedItem>> alternatives;
+        for (const auto& alternative : slot.alternatives) {
+            bool fits = all_of(alternative.begin(), alternative.end(),
+                               [&](const MealPlanResult::PlannedItem& planned) {
+                                   return !blocked(planned.item, slot.day);
+                               });
+            if (fits) alternatives.push_back(alternative);
         }
+        track(slot, 1);
+
+        MealPlanResult& day = plan.days[slot.day];
+        day.selectedMeals[slot.mealType] = slot.alternatives.front();
+        day.alternativeMeals[slot.mealType] = alternatives;
+        day.solveInfo[slot.mealType] = slot.info;
+        plan.objective += slot.info.objective;
+    }
+    for (const auto& entry : usage) {
+        plan.itemDays[entry.first] = static_cast<int>(entry.second.size());
+    }
+
+    return plan;
+}
 
-        ostringstream targetStream;
-        targetStream << targets.calories << " "
-                     << targets.protein  << " "
-                     << targets.carbs    << " "
-                     << targets.fats;
+// Solves one meal with solver.py. The solver worker gets the planning
+// vectors and goal directly and answers with menu indices; on Windows
+// menu.py writes the simplified menu file, solver.py runs once on it, and its
+// "name\tservings" lines, with '#' trailers for the solve status,
+// objective, and optimality gap, are matched back by name.
+vector<MenuManager::MealPlanResult::PlannedItem> MenuManager::planWithPython(
+    const vector<FoodItem>& menu, const vector<MacroVector>& items,
+    const MacroVector& goal, const vector<bool>& excluded, const string& mealType,
+    const string& date, MealPlanResult::MealSolveInfo& info) {
+    vector<MealPlanResult::PlannedItem> planned;
 
 #ifndef _WIN32
-        string solverCmd =
-            PY + " solver.py \"" + simplifiedPath + "\" " + targetStream.str() +
-            " > \"" + planPath + "\" 2>/dev/null";
+    // Only the allowed rows are sent; rows[k] maps the worker's index k
+    // back to the menu.
+    vector<int> rows;
+    vector<MacroVector> allowed;
+    for (size_t j = 0; j < items.size(); j++) {
+        if (j < excluded.size() && excluded[j]) continue;
+        rows.push_back(static_cast<int>(j));
+        allowed.push_back(items[j]);
+    }
+
+    SolverWorker::Solution solution;
+    auto start = chrono::steady_clock::now();
+    bool solved = solverWorkerFor(mealType).solve(allowed, goal, planOptions.deadlineMs,
+                                     planOptions.pythonFormulation, solution);
+    double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!solved) {
+        cerr << "Error: solver.py failed for " << mealType << " on " << date
+             << ": " << solution.error << endl;
+        info.status = SolveStatus::Failed;
+        info.error  = solution.error;
+        return planned;
+    }
+
+    info.optimal     = solution.optimal;
+    info.deadlineHit = solution.deadlineHit;
+    info.status      = solution.optimal ? SolveStatus::Optimal
+                     : solution.presolvedOptimal ? SolveStatus::PresolvedOptimal
+                     : solution.deadlineHit ? SolveStatus::Deadline : SolveStatus::Feasible;
+    info.objective   = solution.objective;
+    info.gap         = solution.gap;
+    info.itemsBefore = solution.itemsBefore;
+    info.itemsAfter  = solution.itemsAfter;
+    info.nodes       = solution.nodes;
+
+    // Time outside the worker's own build and solve (framing, pipe
+    // transfer, and the reply) counts as building.
+    info.solveSeconds = solution.solveMs / 1000.0;
+    info.buildSeconds = max(wallSeconds - info.solveSeconds, 0.0);
+    for (const auto& pick : solution.servings) {
+        if (pick.second > 0.0) {
+            planned.push_back({menu[rows[pick.first]], pick.second});
+        }
+    }
 #else
-        string solverCmd =
-            "python solver.py \"" + simplifiedPath + "\" " + targetStream.str() +
-            " > \"" + planPath + "\" 2>NUL";
-#endif
+    // solver.py reads the whole simplified menu file here, so the names of
+    // the items the diet filter rules out go to it in a second file.
+    (void)items;
+    string baseFilename = mealType + "-" + date + ".json";
+    string simplifiedPath = "../data/menus/simplified-" + baseFilename;
+    string planPath = "../data/menus/plan-" + mealType + "-" + date + ".txt";
+    string excludePath = "../data/menus/exclude-" + mealType + "-" + date + ".txt";
+
+    // solver.py reads its menu from a file, so write the simplified menu
+    // with menu.py's copy of the same station rules.
+    string simplifyCmd =
+        "python -c \"from menu import simplify_menu_file; "
+        "simplify_menu_file('" + baseFilename + "')\""
+        " > NUL 2>&1";
+
+    int simplifyStatus = std::system(simplifyCmd.c_str());
+    if (simplifyStatus != 0) {
+        cerr << "Error: simplify_menu_file failed for "
+             << baseFilename
+             << " with status " << simplifyStatus << endl;
+        info.status = SolveStatus::Failed;
+        info.error  = "simplify_menu_file exited with status " + to_string(simplifyStatus);
+        return planned;
+    }
 
-        int solverStatus = std::system(solverCmd.c_str());
-        if (solverStatus != 0) {
-            cerr << "Error: solver.py failed for "
-                 << simplifiedPath
-                 << " with status " << solverStatus << endl;
-            continue;
+    // solver.py plans as many nutrients as it is given targets for, in
+    // natural units; it applies the plan scales itself.
+    ostringstream targetStream;
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        targetStream << goal[i] / NUTRIENT_INFO[i].planScale << " ";
+    }
+    targetStream << "--deadline-ms " << planOptions.deadlineMs;
+    targetStream << " --formulation " << planOptions.pythonFormulation;
+    if (find(excluded.begin(), excluded.end(), true) != excluded.end()) {
+        ofstream excludeFile(excludePath);
+        for (size_t j = 0; j < menu.size() && j < excluded.size(); j++) {
+            if (excluded[j]) excludeFile << menu[j].name << "\n";
         }
+        targetStream << " --exclude \"" << excludePath << "\"";
+    }
+
+    string solverCmd =
+        "python solver.py \"" + simplifiedPath + "\" " + targetStream.str() +
+        " > \"" + planPath + "\" 2>NUL";
+
+    int solverStatus = std::system(solverCmd.c_str());
+    if (solverStatus != 0) {
+        cerr << "Error: solver.py failed for "
+             << simplifiedPath
+             << " with status " << solverStatus << endl;
+        info.status = SolveStatus::Failed;
+        info.error  = "solver.py exited with status " + to_string(solverStatus);
+        return planned;
+    }
 
-        ifstream planFile(planPath);
-        if (!planFile.is_open()) {
+    ifstream planFile(planPath);
+    string line;
+    while (getline(planFile, line)) {
+        if (line.empty()) continue;
+        size_t tabPos = line.find('\t');
+        if (tabPos == string::npos) continue;
+
+        string itemName    = line.substr(0, tabPos);
+        string servingsStr = line.substr(tabPos + 1);
+
+        if (itemName == "#status") {
+            info.optimal     = servingsStr == "optimal";
+            info.deadlineHit = servingsStr == "deadline";
+            info.status      = info.optimal ? SolveStatus::Optimal
+                             : servingsStr == "presolved" ? SolveStatus::PresolvedOptimal
+                             : info.deadlineHit ? SolveStatus::Deadline : SolveStatus::Feasible;
             continue;
         }
 
-        vector<FoodItem> fullMenu = getDailyMenu(mealType, result.dateStr);
-        if (fullMenu.empty()) {
+        try {
+            if (itemName == "#objective") {
+                info.objective = stod(servingsStr);
+                continue;
+            }
+            if (itemName == "#gap") {
+                info.gap = stod(servingsStr);
+                continue;
+            }
+            if (itemName == "#items_before") {
+                info.itemsBefore = stoi(servingsStr);
+                continue;
+            }
+            if (itemName == "#items_after") {
+                info.itemsAfter = stoi(servingsStr);
+                continue;
+            }
+            if (itemName == "#build_ms") {
+                info.buildSeconds = stod(servingsStr) / 1000.0;
+                continue;
+            }
+            if (itemName == "#solve_ms") {
+                info.solveSeconds = stod(servingsStr) / 1000.0;
+                continue;
+            }
+            if (itemName == "#nodes") {
+                info.nodes = stoll(servingsStr);
+                continue;
+            }
+
+            double servings = stod(servingsStr);
+
+            auto it = find_if(
+                menu.begin(), menu.end(),
+                [&](const FoodItem& fi) { return fi.name == itemName; }
+            );
+            if (it != menu.end() && servings > 0.0) {
+                planned.push_back({*it, servings});
+            }
+        } catch (...) {
             continue;
         }
+    }
+#endif
 
-        string line;
-        while (getline(planFile, line)) {
-            if (line.empty()) continue;
-            size_t tabPos = line.find('\t');
-            if (tabPos == string::npos) continue;
+    return planned;
+}
 
-            string itemName    = line.substr(0, tabPos);
-            string servingsStr = line.substr(tabPos + 1);
+// Solves one meal natively within the per-meal deadline, with the
+// portfolio or the station decomposition.
+vector<vector<MenuManager::MealPlanResult::PlannedItem>> MenuManager::planWithEngine(
+    const vector<FoodItem>& menu, const MenuModel& model,
+    const MacroVector& goal, const PlanSolution* warmStart,
+    PlanSolution& solution, MealPlanResult::MealSolveInfo& info,
+    bool singleThreaded, const vector<bool>& excluded) {
+    vector<vector<MealPlanResult::PlannedItem>> alternatives;
+
+    PlanSettings settings = planOptions.engine;
+    settings.timeLimitMs = planOptions.deadlineMs;
+    settings.singleThreaded = singleThreaded;
+    settings.excluded = excluded;
+    settings.alternatives = planOptions.alternatives;
+    settings.minItemDifference = planOptions.minItemDifference;
+
+    auto start = chrono::steady_clock::now();
+    PresolveResult presolved = PlanningEngine::presolve(model, goal, settings);
+    auto presolveEnd = chrono::steady_clock::now();
+    info.buildSeconds = chrono::duration<double>(presolveEnd - start).count();
+    info.itemsBefore = static_cast<int>(menu.size());
+    info.itemsAfter  = static_cast<int>(presolved.keptItems.size());
+#ifdef DEBUG
+    cerr << "Presolve: " << info.itemsBefore << " -> " << info.itemsAfter
+         << " items (" << presolved.excluded << " excluded, "
+         << presolved.overBudget << " over budget, "
+         << presolved.merged << " merged, " << presolved.dominated
+         << " dominated)" << endl;
+#endif
 
-            try {
-                double servings = stod(servingsStr);
-
-                auto it = find_if(
-                    fullMenu.begin(), fullMenu.end(),
-                    [&](const FoodItem& fi) { return fi.name == itemName; }
-                );
-                if (it != fullMenu.end() && servings > 0.0) {
-                    MealPlanResult::PlannedItem planned;
-                    planned.item     = *it;
-                    planned.servings = servings;
-                    result.selectedMeals[mealType].push_back(planned);
-                }
-            } catch (...) {
-                continue;
-            }
+    if (planOptions.solverMode == SolverMode::Decomposed) {
+        // Station ids in order of first appearance in the menu.
+        map<string, int> stationIds;
+        vector<int> stations;
+        for (const auto& item : menu) {
+            auto inserted = stationIds.insert({item.station, static_cast<int>(stationIds.size())});
+            stations.push_back(inserted.first->second);
         }
+        solution = engine.solveDecomposed(model, goal, presolved.keptItems,
+                                          stations, settings, warmStart);
+    } else {
+        solution = engine.solvePortfolio(model, goal, presolved.keptItems,
+                                         settings, warmStart);
     }
 
-    return result;
+    // The search's bound only covers the kept items. When presolve's
+    // heuristic rules dropped any, bound the whole allowed menu instead.
+    bool lossy = presolved.overBudget + presolved.merged + presolved.dominated > 0;
+    double lowerBound = solution.lowerBound;
+    if (lossy) {
+        vector<int> allowed;
+        for (size_t j = 0; j < menu.size(); j++) {
+            if (j < excluded.size() && excluded[j]) continue;
+            allowed.push_back(static_cast<int>(j));
+        }
+        lowerBound = PlanningEngine::relaxationBound(model, goal, allowed, settings,
+                                                     solution.relaxed);
+    }
+
+    info.solveSeconds =
+        chrono::duration<double>(chrono::steady_clock::now() - presolveEnd).count();
+    info.optimal     = solution.optimal && !lossy;
+    info.deadlineHit = solution.timedOut;
+    info.status      = info.optimal ? SolveStatus::Optimal
+                     : solution.optimal ? SolveStatus::PresolvedOptimal
+                     : solution.timedOut ? SolveStatus::Deadline : SolveStatus::Feasible;
+    info.objective   = solution.objective;
+    info.gap         = max(solution.objective - lowerBound, 0.0);
+    info.nodes       = solution.nodes;
+
+    for (const auto& plan : solution.alternatives) {
+        vector<MealPlanResult::PlannedItem> planned;
+        for (size_t j = 0; j < menu.size(); j++) {
+            if (plan.levels[j] == 0) continue;
+            MealPlanResult::PlannedItem item;
+            item.item     = menu[j];
+            item.servings = plan.levels[j] * settings.servingStep;
+            planned.push_back(item);
+        }
+        if (!planned.empty()) {
+            alternatives.push_back(planned);
+        }
+    }
+
+    return alternatives;
 }
 
 // Logs a menu entry selected by index for a specific meal and date.
@@ -500,10 +1494,10 @@ bool MenuManager::removeLoggedMeal(User& user, const string& date,
     return true;
 }
 
-// Computes total calories and macros for all meals logged on a date.
+// Computes total nutrients for all meals logged on a date.
 MenuManager::DailyTotals MenuManager::calculateDailyTotals(
     const User& user, const string& date) {
-    DailyTotals totals{0, 0.0, 0.0, 0.0};
+    DailyTotals totals{};
 
     auto dateIt = user.loggedMeals.find(date);
     if (dateIt == user.loggedMeals.end()) {
@@ -520,10 +1514,7 @@ MenuManager::DailyTotals MenuManager::calculateDailyTotals(
 
             for (const auto& item : menu) {
                 if (item.name == foodName) {
-                    totals.calories += static_cast<int>(item.calories * servings);
-                    totals.protein  += item.protein * servings;
-                    totals.carbs    += item.carbs * servings;
-                    totals.fats     += item.fats * servings;
+                    totals.addScaled(item.nutrients, servings);
                     break;
                 }
             }
@@ -2,22 +2,174 @@
 #define MENUMANAGER_H
 
 #include "User.h"
+#include "PlanningEngine.h"
+#include "PlanCache.h"
+#include "SolverWorker.h"
+#include "MacroIndex.h"
+#include "DietIndex.h"
+#include "Nutrislice.h"
+#include <mutex>
 #include <string>
 #include <vector>
+#include <iosfwd>
 #include <map>
+#include <memory>
+#include <tuple>
 
 // Manages menu loading, display, logging, and meal-plan generation.
 class MenuManager {
+public:
+    // Which solver generateMealPlan uses for each meal.
+    enum class SolverMode {
+        Python,     // solver.py (cvxpy + ECOS_BB) in a subprocess
+        Portfolio,  // native PlanningEngine racing several strategies
+        Decomposed  // native PlanningEngine, per-station sub-plans + master
+    };
+
+    // How a meal plan was produced relative to the previous one.
+    enum class PlanReuse {
+        Reused,     // targets unchanged; previous plan returned as is
+        Repaired,   // targets moved slightly; solved warm from the previous plan
+        Cached,     // served from the persistent plan cache without solving
+        Recomputed  // no usable previous plan; solved from scratch
+    };
+
+    // How the solve behind a meal plan finished.
+    enum class SolveStatus {
+        Optimal,   // proven optimal within the gap limits
+        PresolvedOptimal,  // optimal over the items presolve kept; the gap
+                           // is measured against the whole menu
+        Feasible,  // best plan found, finished without a proof
+        Deadline,  // cut short by the per-meal deadline
+        Failed     // the solver returned no plan; see MealSolveInfo::error
+    };
+
+    // Default latency budget for solving one meal, in milliseconds.
+    static constexpr int DEFAULT_MEAL_DEADLINE_MS = 200;
+
+    // Settings that control meal-plan generation.
+    struct PlanOptions {
+        SolverMode solverMode = SolverMode::Python;
+
+        // Per-meal deadline; when it passes, the solver returns the best
+        // plan found so far. Overrides engine.timeLimitMs.
+        int deadlineMs = DEFAULT_MEAL_DEADLINE_MS;
+
+        PlanSettings engine;
+
+        // Exact model solver.py builds: "onehot" (a boolean per serving
+        // size) or "integer" (a serving level per item plus an indicator).
+        std::string pythonFormulation = "onehot";
+
+        // Alternative plans offered per meal by the native solvers (1 means
+        // the best plan only), and how many chosen items each must differ
+        // by from the others.
+        int alternatives = 1;
+        int minItemDifference = 0;
+
+        // Relative goal change (||new - old|| / ||old||) up to which the
+        // previous plan for a meal is repaired instead of recomputed.
+        double repairTolerance = 0.25;
+
+        // Persistent plan cache: backing file (empty disables it), entry
+        // limit, and the resolution targets are rounded to for its keys.
+        std::string planCachePath = "../data/plan_cache.tsv";
+        std::size_t planCacheEntries = 1000;
+        double cacheCalorieStep = 10.0;
+        double cacheGramStep = 1.0;
+
+        // Multi-day plans: most days any one item may appear on, fewest
+        // days between two appearances (1 allows consecutive days), and
+        // how many times every meal is re-solved against the others.
+        int maxItemDays = 2;
+        int minRepeatGapDays = 2;
+        int varietyPasses = 1;
+
+        // Stations whose items the repetition limits cover, matched as
+        // substrings of the station name; sides, desserts, and drinks
+        // elsewhere may repeat freely. Empty covers every station.
+        std::vector<std::string> varietyStations = {"Entree", "Entrée"};
+
+        // Config file listing the stations each meal type's simplified
+        // menu leaves out (see station_rules.conf).
+        std::string stationRulesPath = "station_rules.conf";
+
+        // Menu ingestion: false runs menu.py, which saves menus under
+        // data/menus; true fetches Nutrislice weeks in-process from the
+        // configured district and school and keeps them in memory.
+        bool nativeIngestion = false;
+        NutrisliceClient::Config nutrislice;
+    };
+
+    // Stations one meal type's simplified menu leaves out: those named
+    // exactly, and those whose name contains any of the substrings.
+    struct StationRules {
+        std::vector<std::string> exact;
+        std::vector<std::string> contains;
+    };
+
 private:
-    // Loads a menu for one meal and date from a JSON file on disk.
-    std::vector<FoodItem> loadMenuFromFile(const std::string& filepath);
+    PlanOptions planOptions;
+    PlanningEngine engine;
+    PlanCache planCache;
+    // solver.py workers, one per meal type up to the number of cores, so
+    // the meals of a plan can solve at the same time; each process starts
+    // on its first solve.
+    std::vector<std::unique_ptr<SolverWorker>> solverWorkers;
+
+    // Returns the worker that solves mealType's plans.
+    SolverWorker& solverWorkerFor(const std::string& mealType);
+
+    // Station rules per meal type, from planOptions.stationRulesPath.
+    std::map<std::string, StationRules> stationRules;
+
+    // Menus fetched by native ingestion this session, per (meal type,
+    // date), in menu order; every day of a fetched week is kept.
+    std::map<std::pair<std::string, std::string>, std::vector<FoodItem>> ingestedMenus;
+    std::mutex ingestMutex;
+
+    // Returns one meal's menu in menu order, fetching it first with menu.py
+    // or natively per planOptions.nativeIngestion; empty if unavailable.
+    std::vector<FoodItem> loadMenu(const std::string& mealType, const std::string& date);
+
+    // Per-meal nutrient budget handed to the solver.
+    typedef Nutrients MealTargets;
+
+    // Parses menu JSON in the layout menu.py writes, sorted by station
+    // and name unless sortItems is false (items then stay in file order).
+    static std::vector<FoodItem> parseMenu(std::istream& json, bool sortItems = true);
 
 public:
     // Constructs a menu manager; filepath is kept for legacy callers but unused.
     MenuManager(const std::string& filepath = "./data/menu.json");
 
+    // Replaces the settings used by generateMealPlan.
+    void setPlanOptions(const PlanOptions& options);
+
+    // Returns the settings used by generateMealPlan.
+    const PlanOptions& getPlanOptions() const;
+
+    // Returns hit/miss counts and size of the persistent plan cache.
+    PlanCache::Stats getPlanCacheStats() const;
+
+    // Reads station rules per meal type from a config file in the
+    // station_rules.conf layout; a missing file yields no rules.
+    static std::map<std::string, StationRules> loadStationRules(const std::string& filepath);
+
+    // Builds the solver's menu from a menu in file order: drops the
+    // stations the rules exclude and every repeat of an item name
+    // (case-insensitive, first kept), then sorts by station and name.
+    static std::vector<FoodItem> simplifyMenu(const std::vector<FoodItem>& menu,
+                                              const StationRules& rules);
+
+    // Returns the items of menu that pass a diet filter such as "vegan, no
+    // peanuts" (all of them if the filter is empty).
+    static std::vector<FoodItem> filterMenu(const std::vector<FoodItem>& menu,
+                                            const std::string& dietFilter);
+
     // Returns the menu for a given meal type ("breakfast", "lunch", "dinner")
-    // and date string ("YYYY-MM-DD").
+    // and date string ("YYYY-MM-DD"), fetching it if needed, sorted by
+    // station and name.
     std::vector<FoodItem> getDailyMenu(const std::string& mealType,
                                        const std::string& date);
 
@@ -28,22 +180,19 @@ public:
     void displayMenuTable(const std::vector<FoodItem>& menu);
 
     // Aggregated nutrition totals for a single day.
-    struct DailyTotals {
-        int calories;
-        double protein;
-        double carbs;
-        double fats;
-    };
+    typedef Nutrients DailyTotals;
+
+    // Returns the user's daily target for every nutrient: the calorie goal,
+    // macros from the macro ratio, and the fiber, sugar, and sodium goals.
+    static Nutrients dailyGoals(const User& user);
 
     // Full result of generating a meal plan for a single day.
     struct MealPlanResult {
         // Date for which the plan was generated ("YYYY-MM-DD").
         std::string dateStr;
 
-        int calorieGoal;
-        double proteinGoal;
-        double carbsGoal;
-        double fatsGoal;
+        // Daily target for every nutrient.
+        Nutrients goals;
 
         // Totals from all meals the user has already logged for this date.
         DailyTotals loggedTotals;
@@ -59,11 +208,232 @@ public:
 
         // Planned items per meal type (keys: "breakfast", "lunch", "dinner").
         std::map<std::string, std::vector<PlannedItem>> selectedMeals;
+
+        // Ranked alternative plans per meal type, best first; the first
+        // matches selectedMeals. Only the native solvers return more than one.
+        std::map<std::string, std::vector<std::vector<PlannedItem>>> alternativeMeals;
+
+        // How the solver finished one meal.
+        struct MealSolveInfo {
+            // True if the plan was proven optimal for the whole menu
+            // before the deadline.
+            bool optimal = false;
+
+            // True if the deadline cut the search short.
+            bool deadlineHit = false;
+
+            // Squared macro error of the returned plan.
+            double objective = 0.0;
+
+            // Objective minus the best known lower bound.
+            double gap = 0.0;
+
+            // Candidate items before and after presolve.
+            int itemsBefore = 0;
+            int itemsAfter = 0;
+
+            // How the solve finished, and why it failed if it did.
+            SolveStatus status = SolveStatus::Feasible;
+            std::string error;
+
+            // Wall time spent building the model (menu model, presolve,
+            // and for solver.py shipping the matrix and compiling its
+            // model) and searching for the plan. Zero for reused and
+            // cached plans.
+            double buildSeconds = 0.0;
+            double solveSeconds = 0.0;
+
+            // Branch-and-bound nodes explored.
+            long long nodes = 0;
+
+            // How the plan relates to the previous plan for this meal.
+            PlanReuse reuse = PlanReuse::Recomputed;
+        };
+
+        // Solve outcome per planned meal type, and for meals whose solve
+        // failed.
+        std::map<std::string, MealSolveInfo> solveInfo;
+
+        // What a planned meal was solved against: its nutrient budget, the
+        // simplified menu, and a nearest-neighbor index over the menu's
+        // planning vectors, kept so swaps need no further solve.
+        struct MealMenu {
+            Nutrients targets;
+            std::vector<FoodItem> items;
+            MacroIndex index;
+            // Items the user's diet filter rules out (empty if none).
+            std::vector<bool> excluded;
+        };
+
+        // Menu per planned meal type (generateMealPlan only).
+        std::map<std::string, MealMenu> menus;
     };
 
+    // A candidate replacement for one planned item: the item, suggested
+    // servings, and its squared distance in planning units (to the
+    // replaced item per serving, or to the meal budget for gap fillers).
+    struct SwapSuggestion {
+        FoodItem item;
+        double servings;
+        double distance;
+    };
+
+    // Returns up to count menu items whose per-serving macros are nearest
+    // to those of meal[position], at its servings. Items already in the
+    // meal or ruled out by the diet filter are left out. Empty if the plan
+    // has no menu for mealType.
+    std::vector<SwapSuggestion> similarItems(
+        const MealPlanResult& plan, const std::string& mealType,
+        const std::vector<MealPlanResult::PlannedItem>& meal, std::size_t position,
+        std::size_t count) const;
+
+    // Returns up to count menu items, each at its best serving level,
+    // that best fill what the meal misses of its budget once
+    // meal[position] is removed, best fit first.
+    std::vector<SwapSuggestion> gapFillers(
+        const MealPlanResult& plan, const std::string& mealType,
+        const std::vector<MealPlanResult::PlannedItem>& meal, std::size_t position,
+        std::size_t count) const;
+
     // Generates a meal plan for today using the user's goals and logged meals.
     MealPlanResult generateMealPlan(const User& user);
 
+    // Plans for many users at once, with per-item demand totals.
+    struct BatchPlanResult {
+        // Date planned for ("YYYY-MM-DD").
+        std::string dateStr;
+
+        // Plan per user id, shaped like generateMealPlan's result.
+        std::map<std::string, MealPlanResult> plans;
+
+        // Forecast demand: planned servings per meal type and item name.
+        std::map<std::string, std::map<std::string, double>> demand;
+
+        // Meal plans produced, how many came from the plan cache, and the
+        // wall time spent solving (menu loading excluded).
+        int mealPlans = 0;
+        int cachedPlans = 0;
+        double solveSeconds = 0.0;
+
+        // Throughput of the solve phase.
+        double plansPerSecond() const {
+            return solveSeconds > 0.0 ? mealPlans / solveSeconds : 0.0;
+        }
+    };
+
+    // Plans every meal of a date for every user. Each meal's menu is
+    // fetched, simplified, and modeled once; the users' solves then run
+    // in parallel on threadCount workers (0 means one per hardware
+    // thread), each solve single-threaded. Batch runs always use the
+    // native engine, in decomposed mode if configured and portfolio
+    // mode otherwise, and skip warm starts.
+    BatchPlanResult generateBatchPlans(const std::vector<User>& users,
+                                       const std::string& date,
+                                       unsigned threadCount = 0);
+
+    // Plans for consecutive days under variety limits, built from per-meal
+    // solves rather than one joint solve.
+    struct MultiDayPlanResult {
+        // One result per day, in date order.
+        std::vector<MealPlanResult> days;
+
+        // Number of days each planned item appears on.
+        std::map<std::string, int> itemDays;
+
+        // Sum of the meals' squared errors, improvement passes run (not
+        // counting the first), and total solve time.
+        double objective = 0.0;
+        int passes = 0;
+        double solveSeconds = 0.0;
+    };
+
+    // Plans every unlogged meal of dayCount days from startDate in one
+    // session. Menus are loaded once and identical menus share one model.
+    // Meals are solved day by day with entrées (varietyStations) at their
+    // repetition limits (maxItemDays, minRepeatGapDays) excluded, while
+    // other items may repeat; then each pass re-solves every meal against
+    // all the others and keeps improvements. These are block-coordinate
+    // passes, so the week is a local optimum at best, not jointly optimal.
+    // Always uses the native engine (portfolio unless decomposed is
+    // configured).
+    MultiDayPlanResult generateMultiDayPlan(const User& user,
+                                            const std::string& startDate,
+                                            int dayCount);
+
+private:
+    // Last plan per (user id, meal type, menu version), kept so that
+    // re-planning after a small target change can start from it.
+    struct WarmStart {
+        SolverMode solverMode;
+        MacroVector goal;
+        std::vector<bool> excluded;
+        PlanSolution solution;
+        std::vector<std::vector<MealPlanResult::PlannedItem>> alternatives;
+        MealPlanResult::MealSolveInfo info;
+    };
+    typedef std::tuple<std::string, std::string, std::uint64_t> WarmKey;
+    std::map<WarmKey, WarmStart> warmStarts;
+    std::mutex warmMutex;
+
+    // Held by a meal's native solve, so meals planned together take turns
+    // on the engine's pool instead of splitting it.
+    std::mutex engineSolveMutex;
+
+    // Fills result's goals, logged totals, and logged-meal flags for
+    // result.dateStr and returns the nutrient budget of each unlogged meal.
+    std::map<std::string, MealTargets> mealBudgets(const User& user,
+                                                   MealPlanResult& result);
+
+    // Fetches one meal's menu and simplifies it in memory with the
+    // meal type's station rules; returns an empty menu on failure.
+    std::vector<FoodItem> loadSimplifiedMenu(const std::string& mealType,
+                                             const std::string& date);
+
+    // Builds the plan cache key for a menu hash (with the diet exclusions
+    // mixed in) and a goal: the targets quantized to the cache resolution,
+    // plus the solver mode, formulation, alternatives settings, solve
+    // limits (item count, serving levels, and step), and deadline, which
+    // all change the plans a solve returns.
+    std::string planCacheKey(std::uint64_t menuHash, const MacroVector& goal,
+                             SolverMode mode) const;
+
+    // Rebuilds cached plans for key against the menu; returns false on a
+    // miss. The best plan is re-scored against goal, since the key only
+    // matches it to the cache resolution, and solution gets its levels for
+    // later warm starts.
+    bool planFromCache(const std::vector<FoodItem>& menu, const std::string& key,
+                       const MacroVector& goal,
+                       std::vector<std::vector<MealPlanResult::PlannedItem>>& alternatives,
+                       PlanSolution& solution, MealPlanResult::MealSolveInfo& info);
+
+    // Stores freshly solved plans under key, by menu index.
+    void storeInCache(const std::vector<FoodItem>& menu, const std::string& key,
+                      const std::vector<std::vector<MealPlanResult::PlannedItem>>& alternatives,
+                      const MealPlanResult::MealSolveInfo& info);
+
+    // Solves one meal with solver.py for the planning goal over the
+    // menu's planning vectors (items, in menu order), leaving out excluded
+    // items, on the meal type's worker.
+    std::vector<MealPlanResult::PlannedItem> planWithPython(
+        const std::vector<FoodItem>& menu, const std::vector<MacroVector>& items,
+        const MacroVector& goal, const std::vector<bool>& excluded,
+        const std::string& mealType, const std::string& date,
+        MealPlanResult::MealSolveInfo& info);
+
+    // Solves one meal in-process with the planning engine, using the
+    // portfolio or the station decomposition per the solver mode, warm
+    // from an earlier solution when one is given. singleThreaded keeps
+    // the solve on the calling thread; excluded items are never planned.
+    // Returns the ranked alternatives, best first.
+    std::vector<std::vector<MealPlanResult::PlannedItem>> planWithEngine(
+        const std::vector<FoodItem>& menu, const MenuModel& model,
+        const MacroVector& goal, const PlanSolution* warmStart,
+        PlanSolution& solution, MealPlanResult::MealSolveInfo& info,
+        bool singleThreaded = false,
+        const std::vector<bool>& excluded = std::vector<bool>());
+
+public:
+
     // Logs a menu choice by index for a given meal and date.
     bool logMeal(User& user, const std::string& mealType,
                  const std::string& date, int menuNumber, double servings);
@@ -6,6 +6,7 @@
 #include <map>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 using namespace std;
 
@@ -76,8 +77,6 @@ void MenuUI::showDailyMenu() {
             return;
     }
 
-    UIUtils::fetchMenuFor(dateStr, mealType);
-
     string friendlyDateStr = dateStr;
     try {
         if (dateStr.size() >= 10) {
@@ -104,7 +103,19 @@ void MenuUI::showDailyMenu() {
          << " - " << YELLOW << mealType << RESET << "\n\n";
 
     try {
-        auto menu = menuManager.getDailyMenu(mealType, dateStr);
+        auto fullMenu = menuManager.getDailyMenu(mealType, dateStr);
+        auto menu = MenuManager::filterMenu(fullMenu, currentUser.dietFilter);
+
+        if (!currentUser.dietFilter.empty() && !fullMenu.empty()) {
+            cout << "  Filtered: " << currentUser.dietFilter << " (" << menu.size()
+                 << " of " << fullMenu.size() << " items)";
+            // Filters saved before terms were checked may hold typos.
+            DietFilter parsed = DietIndex::parseFilter(currentUser.dietFilter);
+            for (size_t k = 0; k < parsed.unknownTerms.size(); k++) {
+                cout << (k > 0 ? ", " : "; ignoring unknown ") << parsed.unknownTerms[k];
+            }
+            cout << "\n\n";
+        }
 
         if (menu.empty()) {
             cout << "\n";
@@ -114,14 +125,15 @@ void MenuUI::showDailyMenu() {
         } else {
             menuManager.displayMenuTable(menu);
 
+            Nutrients goals = MenuManager::dailyGoals(currentUser);
             cout << "\n";
             UIUtils::printSeparator();
             cout << "\n  " << GREEN << BOLD << "Your Targets:" << RESET
                  << " Cal:" << GREEN << currentUser.calorieGoal << RESET
                  << " " << YELLOW << "P:" << fixed << setprecision(0)
-                 << (currentUser.calorieGoal * currentUser.macroRatio.protein / 4.0) << "g" << RESET
-                 << " " << GREEN << "C:" << (currentUser.calorieGoal * currentUser.macroRatio.carbs / 4.0) << "g" << RESET
-                 << " " << CYAN << "F:" << (currentUser.calorieGoal * currentUser.macroRatio.fats / 9.0) << "g" << RESET << "\n";
+                 << goals[Nutrient::Protein] << "g" << RESET
+                 << " " << GREEN << "C:" << goals[Nutrient::Carbs] << "g" << RESET
+                 << " " << CYAN << "F:" << goals[Nutrient::Fats] << "g" << RESET << "\n";
             UIUtils::printSeparator();
         }
     } catch (const exception& e) {
@@ -134,12 +146,11 @@ void MenuUI::showDailyMenu() {
     UIUtils::waitForEnter();
 }
 
-// Shows the generated meal plan for today and offers to log it.
+// Shows the generated meal plan for today, lets the user cycle through
+// alternative plans per meal, and offers to log the chosen plans.
 void MenuUI::showMealGenerator() {
-    const string CYAN   = "\033[36m";
     const string YELLOW = "\033[33m";
     const string GREEN  = "\033[32m";
-    const string BOLD   = "\033[1m";
     const string RESET  = "\033[0m";
 
     UIUtils::clearScreen();
@@ -147,14 +158,6 @@ void MenuUI::showMealGenerator() {
 
     MenuManager::MealPlanResult plan = menuManager.generateMealPlan(currentUser);
 
-    cout << "\n";
-    cout << "  " << BOLD << "Your Daily Goals:" << RESET << "\n";
-    cout << "  - Calories: " << GREEN  << plan.calorieGoal << RESET << "\n";
-    cout << "  - Protein:  " << YELLOW << static_cast<int>(plan.proteinGoal) << "g" << RESET << "\n";
-    cout << "  - Carbs:    " << GREEN  << static_cast<int>(plan.carbsGoal)   << "g" << RESET << "\n";
-    cout << "  - Fats:     " << CYAN   << static_cast<int>(plan.fatsGoal)    << "g" << RESET << "\n";
-    UIUtils::printSeparator();
-
     bool anyGenerated = !plan.selectedMeals.empty();
     bool bLogged = plan.mealLogged.count("breakfast") && plan.mealLogged["breakfast"];
     bool lLogged = plan.mealLogged.count("lunch")     && plan.mealLogged["lunch"];
@@ -162,6 +165,7 @@ void MenuUI::showMealGenerator() {
     bool allLogged = bLogged && lLogged && dLogged;
 
     if (!anyGenerated) {
+        printMealPlan(plan, map<string, size_t>());
         cout << "\n";
         if (allLogged) {
             cout << "  " << GREEN << "All meals for today are already logged. No plan to generate." << RESET << "\n";
@@ -172,12 +176,295 @@ void MenuUI::showMealGenerator() {
         return;
     }
 
-    cout << "\n  " << BOLD << "Generated Meal Plan for Today:" << RESET << "\n\n";
+    // Index of the alternative shown for each meal; cycling re-renders
+    // the stored alternatives without solving again.
+    map<string, size_t> choice;
+    vector<pair<char, string>> cycleKeys = {{'b', "breakfast"}, {'l', "lunch"}, {'d', "dinner"}};
+    string cycleHint;
+    for (const auto& key : cycleKeys) {
+        auto it = plan.alternativeMeals.find(key.second);
+        if (it != plan.alternativeMeals.end() && it->second.size() > 1) {
+            cycleHint += string(", ") + key.first + " = next " + key.second;
+        }
+    }
+
+    char response = 'n';
+    while (true) {
+        printMealPlan(plan, choice);
+
+        cout << "  Do you want to add this meal plan to your daily log? (y/n"
+             << cycleHint << ", s = swap an item): ";
+        cin >> response;
+        response = static_cast<char>(tolower(response));
+
+        if (response == 's') {
+            swapItem(plan, choice);
+            UIUtils::clearScreen();
+            UIUtils::printHeader("PERSONALIZED MEAL PLAN GENERATOR");
+            continue;
+        }
+
+        auto cycle = find_if(cycleKeys.begin(), cycleKeys.end(),
+                             [&](const pair<char, string>& key) { return key.first == response; });
+        if (cycle == cycleKeys.end()) {
+            break;
+        }
+        auto it = plan.alternativeMeals.find(cycle->second);
+        if (it != plan.alternativeMeals.end() && !it->second.empty()) {
+            choice[cycle->second] = (choice[cycle->second] + 1) % it->second.size();
+        }
+        UIUtils::clearScreen();
+        UIUtils::printHeader("PERSONALIZED MEAL PLAN GENERATOR");
+    }
+
+    if (response == 'y') {
+        cout << "\n";
+        for (const auto& pair : plan.selectedMeals) {
+            const string& mType = pair.first;
+            const auto& items   = chosenPlan(plan, choice, mType);
+
+            auto itLogged = plan.mealLogged.find(mType);
+            if (itLogged != plan.mealLogged.end() && itLogged->second) {
+                continue;
+            }
+
+            string displayMeal = mType;
+            displayMeal[0] = toupper(displayMeal[0]);
+
+            for (const auto& planned : items) {
+                const FoodItem& item = planned.item;
+                double servings      = planned.servings;
+
+                menuManager.logFoodItem(currentUser, mType, plan.dateStr, item.name, servings);
+
+                cout << "  " << GREEN << "✓ Added " << displayMeal << ": " << RESET
+                     << item.name << "  (x " << fixed << setprecision(2) << servings << ")\n";
+            }
+        }
+        auth.updateUser(currentUser);
+        cout << "\n  " << GREEN << "Successfully added meal plan to your log!" << RESET << "\n";
+    }
+
+    UIUtils::waitForEnter();
+}
+
+// Plans today and the six days after it in one session, meal by meal, so
+// no item is repeated beyond the variety limits, and offers to log the
+// whole week.
+void MenuUI::showWeekPlanner() {
+    const string CYAN   = "\033[36m";
+    const string YELLOW = "\033[33m";
+    const string GREEN  = "\033[32m";
+    const string BOLD   = "\033[1m";
+    const string RESET  = "\033[0m";
+
+    UIUtils::clearScreen();
+    UIUtils::printHeader("WEEKLY MEAL PLANNER");
+    cout << "\n  Planning 7 days of meals...\n";
+
+    time_t now = time(nullptr);
+    tm* ltm = localtime(&now);
+    char dateBuf[11];
+    strftime(dateBuf, sizeof(dateBuf), "%Y-%m-%d", ltm);
+
+    MenuManager::MultiDayPlanResult week =
+        menuManager.generateMultiDayPlan(currentUser, dateBuf, 7);
+
+    bool anyGenerated = false;
+    vector<string> mealOrder = {"breakfast", "lunch", "dinner"};
+    for (const auto& day : week.days) {
+        cout << "\n  " << CYAN << BOLD << day.dateStr << RESET << "\n";
+        if (day.selectedMeals.empty()) {
+            cout << "    " << YELLOW << "No plan (meals logged or menus unavailable)" << RESET << "\n";
+            continue;
+        }
+        anyGenerated = true;
+
+        Nutrients totals = day.loggedTotals;
+        for (const string& mealType : mealOrder) {
+            auto itSel = day.selectedMeals.find(mealType);
+            if (itSel == day.selectedMeals.end()) continue;
+
+            string mealName = mealType;
+            mealName[0] = toupper(mealName[0]);
+            cout << "    " << YELLOW << left << setw(10) << mealName + ":" << RESET << right;
+            for (size_t k = 0; k < itSel->second.size(); k++) {
+                const auto& planned = itSel->second[k];
+                cout << (k > 0 ? ", " : "") << planned.item.name << " x"
+                     << fixed << setprecision(1) << planned.servings;
+                totals.addScaled(planned.item.nutrients, planned.servings);
+            }
+            cout << "\n";
+        }
+        cout << "    " << GREEN << static_cast<int>(totals[Nutrient::Calories]) << " / "
+             << static_cast<int>(day.goals[Nutrient::Calories]) << " cal" << RESET
+             << ", " << static_cast<int>(totals[Nutrient::Protein]) << "g protein"
+             << ", " << static_cast<int>(totals[Nutrient::Carbs]) << "g carbs"
+             << ", " << static_cast<int>(totals[Nutrient::Fats]) << "g fat\n";
+    }
+
+    if (!anyGenerated) {
+        cout << "\n  " << YELLOW << "No menus available to plan this week." << RESET << "\n";
+        UIUtils::waitForEnter();
+        return;
+    }
+
+    int mostDays = 0;
+    for (const auto& item : week.itemDays) {
+        mostDays = max(mostDays, item.second);
+    }
+    cout << "\n";
+    UIUtils::printSeparator();
+    cout << "  " << week.itemDays.size() << " different items; none on more than "
+         << mostDays << " days. Solved in " << fixed << setprecision(1)
+         << week.solveSeconds << " s.\n"
+         << "  Each meal is planned against the others in " << week.passes + 1
+         << " pass(es); the week is balanced, not jointly optimal.\n\n";
+
+    char response = 'n';
+    cout << "  Do you want to add this week's plan to your log? (y/n): ";
+    cin >> response;
+    if (tolower(response) == 'y') {
+        for (const auto& day : week.days) {
+            for (const auto& meal : day.selectedMeals) {
+                for (const auto& planned : meal.second) {
+                    menuManager.logFoodItem(currentUser, meal.first, day.dateStr,
+                                            planned.item.name, planned.servings);
+                }
+            }
+        }
+        auth.updateUser(currentUser);
+        cout << "\n  " << GREEN << "Successfully added the week's plan to your log!" << RESET << "\n";
+    }
+
+    UIUtils::waitForEnter();
+}
+
+// Returns the alternative currently chosen for a meal, or the best plan.
+const vector<MenuManager::MealPlanResult::PlannedItem>& MenuUI::chosenPlan(
+    const MenuManager::MealPlanResult& plan, const map<string, size_t>& choice,
+    const string& mealType) {
+    auto itAlt = plan.alternativeMeals.find(mealType);
+    auto itChoice = choice.find(mealType);
+    if (itAlt != plan.alternativeMeals.end() && itChoice != choice.end()
+        && itChoice->second < itAlt->second.size()) {
+        return itAlt->second[itChoice->second];
+    }
+    return plan.selectedMeals.at(mealType);
+}
+
+// Mirrors chosenPlan for a plan the caller may modify.
+vector<MenuManager::MealPlanResult::PlannedItem>& MenuUI::editablePlan(
+    MenuManager::MealPlanResult& plan, const map<string, size_t>& choice,
+    const string& mealType) {
+    auto itAlt = plan.alternativeMeals.find(mealType);
+    auto itChoice = choice.find(mealType);
+    if (itAlt != plan.alternativeMeals.end() && itChoice != choice.end()
+        && itChoice->second < itAlt->second.size()) {
+        return itAlt->second[itChoice->second];
+    }
+    return plan.selectedMeals.at(mealType);
+}
+
+// Suggestions come from the meal's macro index, so no solve is needed.
+void MenuUI::swapItem(MenuManager::MealPlanResult& plan, const map<string, size_t>& choice) {
+    const string YELLOW = "\033[33m";
+    const string BOLD   = "\033[1m";
+    const string RESET  = "\033[0m";
+    const size_t SUGGESTIONS = 5;
+
+    cout << "  Swap an item in which meal? (b/l/d): ";
+    char mealKey;
+    cin >> mealKey;
+    map<char, string> meals = {{'b', "breakfast"}, {'l', "lunch"}, {'d', "dinner"}};
+    auto itMeal = meals.find(static_cast<char>(tolower(mealKey)));
+    if (itMeal == meals.end() || !plan.selectedMeals.count(itMeal->second)) {
+        return;
+    }
+    const string& mealType = itMeal->second;
+    vector<MenuManager::MealPlanResult::PlannedItem>& meal = editablePlan(plan, choice, mealType);
+
+    cout << "\n";
+    for (size_t k = 0; k < meal.size(); k++) {
+        cout << "    " << k + 1 << ". " << meal[k].item.name << "  x "
+             << fixed << setprecision(2) << meal[k].servings << "\n";
+    }
+    cout << "  Item to replace (0 to cancel): ";
+    size_t position = 0;
+    if (!(cin >> position) || position == 0 || position > meal.size()) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        return;
+    }
+    position--;
+
+    vector<MenuManager::SwapSuggestion> options =
+        menuManager.similarItems(plan, mealType, meal, position, SUGGESTIONS);
+    size_t similarCount = options.size();
+    vector<MenuManager::SwapSuggestion> fillers =
+        menuManager.gapFillers(plan, mealType, meal, position, SUGGESTIONS);
+    options.insert(options.end(), fillers.begin(), fillers.end());
+    if (options.empty()) {
+        cout << "  " << YELLOW << "No substitutes available for this meal." << RESET << "\n";
+        UIUtils::waitForEnter();
+        return;
+    }
+
+    for (size_t k = 0; k < options.size(); k++) {
+        if (k == 0 && similarCount > 0) {
+            cout << "\n  " << BOLD << "Closest to " << meal[position].item.name << ":" << RESET << "\n";
+        }
+        if (k == similarCount) {
+            cout << "\n  " << BOLD << "Best fit for the rest of the meal:" << RESET << "\n";
+        }
+        const FoodItem& item = options[k].item;
+        double servings = options[k].servings;
+        cout << "    " << k + 1 << ". " << item.name << "  x " << fixed << setprecision(2)
+             << servings << "  (" << static_cast<int>(item.nutrients[Nutrient::Calories] * servings)
+             << " cal, " << static_cast<int>(item.nutrients[Nutrient::Protein] * servings)
+             << "g protein, " << static_cast<int>(item.nutrients[Nutrient::Carbs] * servings)
+             << "g carbs, " << static_cast<int>(item.nutrients[Nutrient::Fats] * servings)
+             << "g fat)\n";
+    }
+
+    cout << "\n  Replacement (0 to cancel): ";
+    size_t picked = 0;
+    if (!(cin >> picked) || picked == 0 || picked > options.size()) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        return;
+    }
+    meal[position] = {options[picked - 1].item, options[picked - 1].servings};
+}
+
+// Prints the daily goals, each meal's chosen plan, and the plan totals.
+void MenuUI::printMealPlan(const MenuManager::MealPlanResult& plan,
+                           const map<string, size_t>& choice) {
+    const string CYAN   = "\033[36m";
+    const string YELLOW = "\033[33m";
+    const string GREEN  = "\033[32m";
+    const string RED    = "\033[31m";
+    const string BOLD   = "\033[1m";
+    const string RESET  = "\033[0m";
+
+    cout << "\n";
+    cout << "  " << BOLD << "Your Daily Goals:" << RESET << "\n";
+    cout << "  - Calories: " << GREEN  << static_cast<int>(plan.goals[Nutrient::Calories]) << RESET << "\n";
+    cout << "  - Protein:  " << YELLOW << static_cast<int>(plan.goals[Nutrient::Protein]) << "g" << RESET << "\n";
+    cout << "  - Carbs:    " << GREEN  << static_cast<int>(plan.goals[Nutrient::Carbs])   << "g" << RESET << "\n";
+    cout << "  - Fats:     " << CYAN   << static_cast<int>(plan.goals[Nutrient::Fats])    << "g" << RESET << "\n";
+    for (int i = Nutrient::Fiber; i < Nutrient::Count; i++) {
+        cout << "  - " << left << setw(10) << string(NUTRIENT_INFO[i].name) + ":" << right
+             << static_cast<int>(plan.goals[i]) << NUTRIENT_INFO[i].unit << "\n";
+    }
+    UIUtils::printSeparator();
 
-    double totalCalories = plan.loggedTotals.calories;
-    double totalProtein  = plan.loggedTotals.protein;
-    double totalCarbs    = plan.loggedTotals.carbs;
-    double totalFats     = plan.loggedTotals.fats;
+    if (plan.selectedMeals.empty()) {
+        return;
+    }
+
+    cout << "\n  " << BOLD << "Generated Meal Plan for Today:" << RESET << "\n\n";
+    Nutrients totals = plan.loggedTotals;
 
     vector<string> mealOrder = {"breakfast", "lunch", "dinner"};
     for (const string& mealType : mealOrder) {
@@ -197,11 +484,53 @@ void MenuUI::showMealGenerator() {
 
         auto itSel = plan.selectedMeals.find(mealType);
         if (itSel == plan.selectedMeals.end() || itSel->second.empty()) {
+            auto itFailed = plan.solveInfo.find(mealType);
+            if (itFailed != plan.solveInfo.end()
+                && itFailed->second.status == MenuManager::SolveStatus::Failed) {
+                cout << "  " << RED << "✗ " << mealName << ": " << RESET
+                     << "no plan (" << itFailed->second.error << ")\n\n";
+            }
             continue;
         }
 
-        const auto& plannedItems = itSel->second;
-        cout << "  " << YELLOW << "⦿ " << mealName << ":" << RESET << "\n";
+        const auto& plannedItems = chosenPlan(plan, choice, mealType);
+        cout << "  " << YELLOW << "⦿ " << mealName << ":" << RESET;
+
+        // Show which alternative is on screen when there are several.
+        auto itAlt = plan.alternativeMeals.find(mealType);
+        if (itAlt != plan.alternativeMeals.end() && itAlt->second.size() > 1) {
+            auto itChoice = choice.find(mealType);
+            size_t shown = itChoice == choice.end() ? 0 : itChoice->second;
+            cout << "  (option " << shown + 1 << " of " << itAlt->second.size() << ")";
+        }
+
+        // Flag plans that were cut short by the per-meal deadline.
+        auto itInfo = plan.solveInfo.find(mealType);
+        if (itInfo != plan.solveInfo.end() && itInfo->second.deadlineHit) {
+            const auto& info = itInfo->second;
+            double relGap = info.objective > 0.0 ? 100.0 * info.gap / info.objective : 0.0;
+            cout << "  (best plan within time limit, gap " << fixed << setprecision(1)
+                 << relGap << "%)";
+        }
+
+        // Say whether the previous plan for this meal was kept or repaired.
+        if (itInfo != plan.solveInfo.end()) {
+            switch (itInfo->second.reuse) {
+                case MenuManager::PlanReuse::Reused:
+                    cout << "  [reused: targets unchanged]";
+                    break;
+                case MenuManager::PlanReuse::Repaired:
+                    cout << "  [repaired from previous plan]";
+                    break;
+                case MenuManager::PlanReuse::Cached:
+                    cout << "  [from plan cache]";
+                    break;
+                case MenuManager::PlanReuse::Recomputed:
+                    cout << "  [recomputed]";
+                    break;
+            }
+        }
+        cout << "\n";
 
         for (const auto& planned : plannedItems) {
             const FoodItem& item = planned.item;
@@ -220,16 +549,13 @@ void MenuUI::showMealGenerator() {
             cout << "    - " << BOLD << item.name << RESET
                  << "  x " << fixed << setprecision(2) << totalAmount
                  << " " << item.servingUnit
-                 << "  (" << item.calories * servings  << " cal"
-                 << ", " << static_cast<int>(item.protein) * servings << "g protein"
-                 << ", " << static_cast<int>(item.carbs) * servings  << "g carbs"
-                 << ", " << static_cast<int>(item.fats) * servings   << "g fat"
+                 << "  (" << item.nutrients[Nutrient::Calories] * servings << " cal"
+                 << ", " << static_cast<int>(item.nutrients[Nutrient::Protein]) * servings << "g protein"
+                 << ", " << static_cast<int>(item.nutrients[Nutrient::Carbs]) * servings   << "g carbs"
+                 << ", " << static_cast<int>(item.nutrients[Nutrient::Fats]) * servings    << "g fat"
                  << ")\n";
 
-            totalCalories += item.calories * servings;
-            totalProtein  += item.protein  * servings;
-            totalCarbs    += item.carbs    * servings;
-            totalFats     += item.fats     * servings;
+            totals.addScaled(item.nutrients, servings);
         }
 
         cout << "\n";
@@ -237,46 +563,28 @@ void MenuUI::showMealGenerator() {
 
     UIUtils::printSeparator();
     cout << "\n  " << BOLD << "Plan Summary:" << RESET << "\n";
-    cout << "  - Total Calories: " << GREEN  << static_cast<int>(totalCalories)
-         << " / " << plan.calorieGoal << RESET << "\n";
-    cout << "  - Total Protein:  " << YELLOW << static_cast<int>(totalProtein)
-         << "g / " << static_cast<int>(plan.proteinGoal) << "g" << RESET << "\n";
-    cout << "  - Total Carbs:    " << GREEN  << static_cast<int>(totalCarbs)
-         << "g / " << static_cast<int>(plan.carbsGoal)   << "g" << RESET << "\n";
-    cout << "  - Total Fats:     " << CYAN   << static_cast<int>(totalFats)
-         << "g / " << static_cast<int>(plan.fatsGoal)    << "g" << RESET << "\n\n";
-
-    cout << "  Do you want to add this meal plan to your daily log? (y/n): ";
-    char response;
-    cin >> response;
-
-    if (response == 'y' || response == 'Y') {
-        cout << "\n";
-        for (const auto& pair : plan.selectedMeals) {
-            const string& mType = pair.first;
-            const auto& items   = pair.second;
-
-            auto itLogged = plan.mealLogged.find(mType);
-            if (itLogged != plan.mealLogged.end() && itLogged->second) {
-                continue;
-            }
-
-            string displayMeal = mType;
-            displayMeal[0] = toupper(displayMeal[0]);
-
-            for (const auto& planned : items) {
-                const FoodItem& item = planned.item;
-                double servings      = planned.servings;
-
-                menuManager.logFoodItem(currentUser, mType, plan.dateStr, item.name, servings);
-
-                cout << "  " << GREEN << "✓ Added " << displayMeal << ": " << RESET
-                     << item.name << "  (x " << fixed << setprecision(2) << servings << ")\n";
-            }
-        }
-        auth.updateUser(currentUser);
-        cout << "\n  " << GREEN << "Successfully added meal plan to your log!" << RESET << "\n";
+    cout << "  - Total Calories: " << GREEN  << static_cast<int>(totals[Nutrient::Calories])
+         << " / " << static_cast<int>(plan.goals[Nutrient::Calories]) << RESET << "\n";
+    cout << "  - Total Protein:  " << YELLOW << static_cast<int>(totals[Nutrient::Protein])
+         << "g / " << static_cast<int>(plan.goals[Nutrient::Protein]) << "g" << RESET << "\n";
+    cout << "  - Total Carbs:    " << GREEN  << static_cast<int>(totals[Nutrient::Carbs])
+         << "g / " << static_cast<int>(plan.goals[Nutrient::Carbs])   << "g" << RESET << "\n";
+    cout << "  - Total Fats:     " << CYAN   << static_cast<int>(totals[Nutrient::Fats])
+         << "g / " << static_cast<int>(plan.goals[Nutrient::Fats])    << "g" << RESET << "\n";
+    for (int i = Nutrient::Fiber; i < Nutrient::Count; i++) {
+        cout << "  - Total " << left << setw(9) << string(NUTRIENT_INFO[i].name) + ":" << right
+             << static_cast<int>(totals[i]) << NUTRIENT_INFO[i].unit << " / "
+             << static_cast<int>(plan.goals[i]) << NUTRIENT_INFO[i].unit << "\n";
     }
+    cout << "\n";
 
-    UIUtils::waitForEnter();
+    // Hit rate of the persistent plan cache across all sessions.
+    PlanCache::Stats cache = menuManager.getPlanCacheStats();
+    uint64_t lookups = cache.hits + cache.misses;
+    if (lookups > 0) {
+        cout << "  Plan cache: " << cache.hits << " hits / " << lookups
+             << " lookups (" << fixed << setprecision(0)
+             << 100.0 * cache.hits / lookups << "%), " << cache.size
+             << " plans stored\n\n";
+    }
 }
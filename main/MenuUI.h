@@ -4,6 +4,9 @@
 #include "MenuManager.h"
 #include "User.h"
 #include "Auth.h"
+#include <map>
+#include <string>
+#include <vector>
 
 // Handles viewing dining hall menus and generated meal plans.
 class MenuUI {
@@ -12,6 +15,25 @@ private:
     User& currentUser;
     Auth& auth;
 
+    // Returns the alternative currently chosen for a meal, or the best plan.
+    static const std::vector<MenuManager::MealPlanResult::PlannedItem>& chosenPlan(
+        const MenuManager::MealPlanResult& plan,
+        const std::map<std::string, size_t>& choice, const std::string& mealType);
+
+    // Returns the shown plan for a meal so it can be edited in place.
+    static std::vector<MenuManager::MealPlanResult::PlannedItem>& editablePlan(
+        MenuManager::MealPlanResult& plan, const std::map<std::string, size_t>& choice,
+        const std::string& mealType);
+
+    // Asks for a planned item, lists the nearest substitutes and the best
+    // fillers for the rest of the meal, and swaps in the one picked.
+    void swapItem(MenuManager::MealPlanResult& plan,
+                  const std::map<std::string, size_t>& choice);
+
+    // Prints the daily goals, each meal's chosen plan, and the plan totals.
+    void printMealPlan(const MenuManager::MealPlanResult& plan,
+                       const std::map<std::string, size_t>& choice);
+
 public:
     // Creates a MenuUI bound to the shared menu manager, user, and auth.
     MenuUI(MenuManager& menuMgrRef, User& userRef, Auth& authRef);
@@ -21,6 +43,9 @@ public:
 
     // Generates and displays a meal plan, with an option to log it.
     void showMealGenerator();
+
+    // Plans the next seven days with variety limits, with an option to log them.
+    void showWeekPlanner();
 };
 
 #endif
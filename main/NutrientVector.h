@@ -0,0 +1,114 @@
+#ifndef NUTRIENTVECTOR_H
+#define NUTRIENTVECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// Nutrients tracked for every item, in storage order. The first four are
+// the macros every menu provides; the others may be missing from a menu
+// and then count as zero.
+namespace Nutrient {
+enum Index { Calories, Protein, Carbs, Fats, Fiber, Sugar, Sodium, Count };
+}
+
+const std::size_t NUTRIENT_COUNT = Nutrient::Count;
+
+// Display name, menu JSON key, and unit of one nutrient. planScale converts
+// the amount into planning units so that no nutrient dominates the
+// squared-error objective just because of its unit (sodium is in mg).
+struct NutrientInfo {
+    const char* name;
+    const char* key;
+    const char* unit;
+    double planScale;
+};
+
+inline constexpr NutrientInfo NUTRIENT_INFO[NUTRIENT_COUNT] = {
+    {"Calories", "calories",  "cal", 1.0},
+    {"Protein",  "g_protein", "g",   1.0},
+    {"Carbs",    "g_carbs",   "g",   1.0},
+    {"Fat",      "g_fat",     "g",   1.0},
+    {"Fiber",    "g_fiber",   "g",   1.0},
+    {"Sugar",    "g_sugar",   "g",   1.0},
+    {"Sodium",   "mg_sodium", "mg",  0.1},
+};
+
+template <typename F, std::size_t... I>
+inline void expandNutrients(F& f, std::index_sequence<I...>) {
+    (f(I), ...);
+}
+
+// Calls f(0), f(1), ..., f(N - 1) as one expanded expression, so loops
+// over a compile-time dimension are unrolled even in unoptimized builds.
+template <std::size_t N, typename F>
+inline void forEachNutrient(F&& f) {
+    expandNutrients(f, std::make_index_sequence<N>());
+}
+
+// Fixed-size vector of nutrient amounts. It is an std::array, so it
+// initializes and indexes like one, with elementwise arithmetic on top.
+template <std::size_t N>
+struct NutrientVector : std::array<double, N> {
+    static constexpr std::size_t dimension = N;
+
+    NutrientVector& operator+=(const NutrientVector& other) {
+        forEachNutrient<N>([&](std::size_t i) { (*this)[i] += other[i]; });
+        return *this;
+    }
+
+    NutrientVector& operator-=(const NutrientVector& other) {
+        forEachNutrient<N>([&](std::size_t i) { (*this)[i] -= other[i]; });
+        return *this;
+    }
+
+    NutrientVector& operator*=(double scale) {
+        forEachNutrient<N>([&](std::size_t i) { (*this)[i] *= scale; });
+        return *this;
+    }
+
+    // Adds scale * other in place (the planner's axpy).
+    NutrientVector& addScaled(const NutrientVector& other, double scale) {
+        forEachNutrient<N>([&](std::size_t i) { (*this)[i] += scale * other[i]; });
+        return *this;
+    }
+
+    double dot(const NutrientVector& other) const {
+        double sum = 0.0;
+        forEachNutrient<N>([&](std::size_t i) { sum += (*this)[i] * other[i]; });
+        return sum;
+    }
+
+    double squaredNorm() const {
+        return dot(*this);
+    }
+
+    // Returns the first M entries, e.g. the planned nutrients of an item.
+    template <std::size_t M>
+    NutrientVector<M> head() const {
+        static_assert(M <= N, "head() cannot grow a vector");
+        NutrientVector<M> out;
+        forEachNutrient<M>([&](std::size_t i) { out[i] = (*this)[i]; });
+        return out;
+    }
+};
+
+template <std::size_t N>
+inline NutrientVector<N> operator+(NutrientVector<N> a, const NutrientVector<N>& b) {
+    return a += b;
+}
+
+template <std::size_t N>
+inline NutrientVector<N> operator-(NutrientVector<N> a, const NutrientVector<N>& b) {
+    return a -= b;
+}
+
+template <std::size_t N>
+inline NutrientVector<N> operator*(NutrientVector<N> a, double scale) {
+    return a *= scale;
+}
+
+// Amounts of every tracked nutrient, in Nutrient::Index order.
+typedef NutrientVector<NUTRIENT_COUNT> Nutrients;
+
+#endif
@@ -0,0 +1,409 @@
+#include "Nutrislice.h"
+#include "HttpClient.h"
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+// Parsed JSON value; objects keep their fields in document order.
+struct Json {
+    enum Type { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    string text;
+    vector<Json> items;
+    vector<pair<string, Json>> fields;
+
+    // Returns the named field of an object, or nullptr.
+    const Json* get(const char* key) const {
+        if (type != Object) return nullptr;
+        for (const auto& field : fields) {
+            if (field.first == key) return &field.second;
+        }
+        return nullptr;
+    }
+
+    bool truthy() const {
+        switch (type) {
+            case Bool:   return boolean;
+            case Number: return number != 0.0;
+            case String: return !text.empty();
+            case Array:  return !items.empty();
+            case Object: return !fields.empty();
+            default:     return false;
+        }
+    }
+};
+
+// Recursive-descent JSON parser over one document.
+class JsonParser {
+public:
+    explicit JsonParser(const string& input) : text(input), pos(0) {}
+
+    bool parseDocument(Json& value, string& error) {
+        if (!parseValue(value, 0) || (skipSpace(), pos != text.size())) {
+            error = "invalid JSON near byte " + to_string(pos);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const int MAX_DEPTH = 64;
+    const string& text;
+    size_t pos;
+
+    void skipSpace() {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    bool literal(const char* word) {
+        size_t length = char_traits<char>::length(word);
+        if (text.compare(pos, length, word) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    bool parseValue(Json& value, int depth) {
+        if (depth > MAX_DEPTH) return false;
+        skipSpace();
+        if (pos >= text.size()) return false;
+
+        char c = text[pos];
+        if (c == '{') return parseObject(value, depth);
+        if (c == '[') return parseArray(value, depth);
+        if (c == '"') {
+            value.type = Json::String;
+            return parseString(value.text);
+        }
+        if (literal("true")) {
+            value.type = Json::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (literal("false")) {
+            value.type = Json::Bool;
+            return true;
+        }
+        if (literal("null")) {
+            value.type = Json::Null;
+            return true;
+        }
+
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        value.number = strtod(start, &end);
+        if (end == start) return false;
+        value.type = Json::Number;
+        pos += static_cast<size_t>(end - start);
+        return true;
+    }
+
+    bool parseObject(Json& value, int depth) {
+        value.type = Json::Object;
+        pos++;
+        skipSpace();
+        if (pos < text.size() && text[pos] == '}') {
+            pos++;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            string key;
+            if (pos >= text.size() || text[pos] != '"' || !parseString(key)) return false;
+            skipSpace();
+            if (pos >= text.size() || text[pos] != ':') return false;
+            pos++;
+            value.fields.emplace_back(move(key), Json());
+            if (!parseValue(value.fields.back().second, depth + 1)) return false;
+            skipSpace();
+            if (pos >= text.size()) return false;
+            if (text[pos] == '}') {
+                pos++;
+                return true;
+            }
+            if (text[pos++] != ',') return false;
+        }
+    }
+
+    bool parseArray(Json& value, int depth) {
+        value.type = Json::Array;
+        pos++;
+        skipSpace();
+        if (pos < text.size() && text[pos] == ']') {
+            pos++;
+            return true;
+        }
+        while (true) {
+            value.items.emplace_back();
+            if (!parseValue(value.items.back(), depth + 1)) return false;
+            skipSpace();
+            if (pos >= text.size()) return false;
+            if (text[pos] == ']') {
+                pos++;
+                return true;
+            }
+            if (text[pos++] != ',') return false;
+        }
+    }
+
+    // Appends a code point as UTF-8.
+    static void appendUtf8(string& out, unsigned long code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    bool parseHex4(unsigned long& code) {
+        if (pos + 4 > text.size()) return false;
+        string digits = text.substr(pos, 4);
+        char* end = nullptr;
+        code = strtoul(digits.c_str(), &end, 16);
+        if (end != digits.c_str() + 4) return false;
+        pos += 4;
+        return true;
+    }
+
+    bool parseString(string& out) {
+        pos++;
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) return false;
+            char escape = text[pos++];
+            switch (escape) {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned long code;
+                    if (!parseHex4(code)) return false;
+                    // Join a surrogate pair into one code point.
+                    if (code >= 0xd800 && code < 0xdc00 && text.compare(pos, 2, "\\u") == 0) {
+                        pos += 2;
+                        unsigned long low;
+                        if (!parseHex4(low)) return false;
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+};
+
+// Trims leading and trailing whitespace from a string.
+string trim(const string& str) {
+    size_t first = str.find_first_not_of(" \t\n\r");
+    if (first == string::npos) return "";
+    size_t last = str.find_last_not_of(" \t\n\r");
+    return str.substr(first, last - first + 1);
+}
+
+// Returns a string or number field as text, or fallback.
+string textField(const Json* value, const string& fallback) {
+    if (value && value->type == Json::String) return value->text;
+    if (value && value->type == Json::Number) {
+        ostringstream out;
+        out << value->number;
+        return out.str();
+    }
+    return fallback;
+}
+
+// Builds one FoodItem from a menu item's "food" object; false if a macro
+// is missing.
+bool readFood(const Json& food, const string& station, FoodItem& item) {
+    item.name = textField(food.get("name"), "");
+    item.station = station;
+    item.ingredients = NutrisliceClient::cleanIngredients(textField(food.get("ingredients"), ""));
+
+    const Json* icons = food.get("icons");
+    const Json* foodIcons = icons ? icons->get("food_icons") : nullptr;
+    if (foodIcons && foodIcons->type == Json::Array) {
+        for (const Json& icon : foodIcons->items) {
+            const Json* synced = icon.get("synced_name");
+            if (synced && synced->type == Json::String) {
+                item.icons.push_back(synced->text);
+            }
+        }
+    }
+
+    // The four macros are required; other nutrients count as zero when
+    // missing or null.
+    const Json* nutrition = food.get("rounded_nutrition_info");
+    for (size_t i = 0; i < NUTRIENT_COUNT; i++) {
+        const Json* amount = nutrition ? nutrition->get(NUTRIENT_INFO[i].key) : nullptr;
+        if (amount && amount->type == Json::Number) {
+            item.nutrients[i] = amount->number;
+        } else if (i <= static_cast<size_t>(Nutrient::Fats)) {
+            return false;
+        }
+    }
+
+    const Json* serving = food.get("serving_size_info");
+    item.servingAmount = textField(serving ? serving->get("serving_size_amount") : nullptr, "1");
+    item.servingUnit = trim(textField(serving ? serving->get("serving_size_unit") : nullptr,
+                                      "serving"));
+    return true;
+}
+
+}  // namespace
+
+NutrisliceClient::NutrisliceClient() {}
+
+NutrisliceClient::NutrisliceClient(const Config& config) : settings(config) {}
+
+string NutrisliceClient::weekUrl(const string& mealType, const string& date) const {
+    string base = settings.baseUrl.empty()
+        ? "https://" + settings.district + ".api.nutrislice.com"
+        : settings.baseUrl;
+    while (!base.empty() && base.back() == '/') base.pop_back();
+
+    // The endpoint takes the date as year/month/day path segments.
+    string path = date;
+    for (char& c : path) {
+        if (c == '-') c = '/';
+    }
+    return base + "/menu/api/weeks/school/" + settings.school + "/menu-type/" + mealType +
+           "/" + path + "/?format=json";
+}
+
+bool NutrisliceClient::fetchWeek(const string& mealType, const string& date,
+                                 WeekMenus& days, string& error) const {
+    string url = weekUrl(mealType, date);
+    HttpClient::Response response;
+    if (!HttpClient::get(url, response, settings.timeoutMs)) {
+        error = response.error;
+        return false;
+    }
+    if (response.status != 200) {
+        error = "Nutrislice returned status " + to_string(response.status) + " for " + url;
+        return false;
+    }
+    return parseWeek(response.body, days, error);
+}
+
+// Sections keep the order they first appear in, and a title seen again
+// adds to its earlier section, as menu.py's dictionary of stations does.
+bool NutrisliceClient::parseWeek(const string& json, WeekMenus& days, string& error) {
+    Json root;
+    if (!JsonParser(json).parseDocument(root, error)) {
+        return false;
+    }
+    const Json* dayList = root.get("days");
+    if (!dayList || dayList->type != Json::Array) {
+        error = "weekly menu has no days";
+        return false;
+    }
+
+    for (const Json& day : dayList->items) {
+        const Json* date = day.get("date");
+        if (!date || date->type != Json::String) continue;
+
+        vector<string> sectionOrder;
+        map<string, vector<FoodItem>> sections;
+        string current = "Uncategorized";
+        const Json* menuItems = day.get("menu_items");
+        if (menuItems && menuItems->type == Json::Array) {
+            for (const Json& entry : menuItems->items) {
+                const Json* sectionTitle = entry.get("is_section_title");
+                if (sectionTitle && sectionTitle->truthy()) {
+                    current = trim(textField(entry.get("text"), "Unnamed Section"));
+                    if (!sections.count(current)) {
+                        sectionOrder.push_back(current);
+                        sections[current];
+                    }
+                    continue;
+                }
+
+                const Json* food = entry.get("food");
+                if (!food || food->type != Json::Object || food->fields.empty()) continue;
+
+                FoodItem item;
+                if (!readFood(*food, current, item)) continue;
+                if (!sections.count(current)) {
+                    sectionOrder.push_back(current);
+                }
+                sections[current].push_back(move(item));
+            }
+        }
+
+        vector<FoodItem>& items = days[date->text];
+        items.clear();
+        for (const string& section : sectionOrder) {
+            for (auto& item : sections[section]) {
+                items.push_back(move(item));
+            }
+        }
+    }
+    return true;
+}
+
+string NutrisliceClient::cleanIngredients(const string& text) {
+    // Drop "(...)" and then "[...]" notes; an unclosed bracket stays.
+    string stripped = text;
+    for (auto brackets : {make_pair('(', ')'), make_pair('[', ']')}) {
+        string kept;
+        size_t pos = 0;
+        while (pos < stripped.size()) {
+            size_t open = stripped.find(brackets.first, pos);
+            size_t close = open == string::npos ? string::npos
+                                                : stripped.find(brackets.second, open + 1);
+            if (close == string::npos) {
+                kept.append(stripped, pos, string::npos);
+                break;
+            }
+            kept.append(stripped, pos, open - pos);
+            pos = close + 1;
+        }
+        stripped.swap(kept);
+    }
+
+    // Punctuation becomes a space (non-ASCII bytes count as word
+    // characters), runs of whitespace collapse, and letters are lowered.
+    string cleaned;
+    bool pendingSpace = false;
+    for (char c : stripped) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        bool word = byte >= 0x80 || isalnum(byte) || c == '_';
+        if (!word) {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace && !cleaned.empty()) cleaned += ' ';
+        pendingSpace = false;
+        cleaned += static_cast<char>(tolower(byte));
+    }
+    return cleaned;
+}
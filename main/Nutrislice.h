@@ -0,0 +1,54 @@
+#ifndef NUTRISLICE_H
+#define NUTRISLICE_H
+
+#include "User.h"
+#include <map>
+#include <string>
+#include <vector>
+
+// Native Nutrislice ingestion: fetches a school's weekly menu for one meal
+// type and parses it straight into FoodItem records, the way menu.py's
+// extract_day_menu does, without Python or intermediate files.
+class NutrisliceClient {
+public:
+    // Where menus come from. An empty baseUrl means the district's live
+    // API (https://<district>.api.nutrislice.com); set it to point at a
+    // stand-in such as nutrislice_standin.py.
+    struct Config {
+        std::string district = "richmond";
+        std::string school = "heilman-dining-hall";
+        std::string baseUrl;
+        int timeoutMs = 10000;
+    };
+
+    // Items per date ("YYYY-MM-DD") of one week, in menu order, with each
+    // item's station set to the section title it appears under.
+    typedef std::map<std::string, std::vector<FoodItem>> WeekMenus;
+
+    NutrisliceClient();
+    explicit NutrisliceClient(const Config& config);
+
+    const Config& config() const { return settings; }
+
+    // Returns the weeks endpoint URL for the week containing date.
+    std::string weekUrl(const std::string& mealType, const std::string& date) const;
+
+    // Fetches and parses the week containing date; false with error set
+    // on a network, HTTP, or parse failure.
+    bool fetchWeek(const std::string& mealType, const std::string& date,
+                   WeekMenus& days, std::string& error) const;
+
+    // Parses a weeks endpoint response. Items missing a macro are skipped,
+    // as when menu.py's files are loaded.
+    static bool parseWeek(const std::string& json, WeekMenus& days, std::string& error);
+
+    // Normalizes ingredient text like menu.py's clean_ingredients:
+    // bracketed and parenthesized notes removed, punctuation turned into
+    // spaces, whitespace collapsed, and lowercase.
+    static std::string cleanIngredients(const std::string& text);
+
+private:
+    Config settings;
+};
+
+#endif
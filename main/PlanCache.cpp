@@ -0,0 +1,274 @@
+#include "PlanCache.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// File layout, one record per line with tab-separated fields:
+//   stats  <hits> <misses> <evictions>
+//   entry  <key> <lastUsed> <objective> <gap> <optimal> <plans>
+// where <lastUsed> ranks entries by recency (larger is more recent) and
+// <plans> is "index:servings,..." per plan, plans separated by ';'.
+
+PlanCache::PlanCache() : capacity(0), deferred(false), dirty(false), unsavedStores(0) {}
+
+PlanCache::~PlanCache() {
+    lock_guard<mutex> lock(cacheMutex);
+    deferred = false;
+    if (dirty) {
+        save();
+    }
+}
+
+void PlanCache::configure(const string& filepath, size_t maxEntries) {
+    lock_guard<mutex> lock(cacheMutex);
+    capacity = maxEntries;
+    if (filepath != path) {
+        if (dirty && !deferred) {
+            save();
+        }
+        path = filepath;
+        slots.clear();
+        recency.clear();
+        counters = Stats();
+        dirty = false;
+        load();
+    }
+
+    if (evict()) {
+        save();
+    }
+}
+
+void PlanCache::touch(Slot& slot) {
+    recency.splice(recency.begin(), recency, slot.used);
+}
+
+bool PlanCache::evict() {
+    bool evicted = false;
+    while (slots.size() > capacity) {
+        slots.erase(recency.back());
+        recency.pop_back();
+        counters.evictions++;
+        evicted = true;
+    }
+    return evicted;
+}
+
+// Hashes names, stations, and nutrients with 64-bit FNV-1a.
+uint64_t PlanCache::hashMenu(const vector<FoodItem>& menu) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const string& text) {
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+    };
+
+    for (const auto& item : menu) {
+        ostringstream amounts;
+        for (double amount : item.nutrients) {
+            amounts << amount << ' ';
+        }
+        mix(item.name);
+        mix(item.station);
+        mix(amounts.str());
+    }
+    return hash;
+}
+
+uint64_t PlanCache::hashExclusions(uint64_t menuHash, const vector<bool>& excluded) {
+    uint64_t hash = menuHash;
+    for (size_t j = 0; j < excluded.size(); j++) {
+        if (excluded[j]) {
+            hash ^= j + 1;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+string PlanCache::makeKey(uint64_t menuHash, const MacroVector& goal,
+                          double calorieStep, double gramStep) {
+    auto bucket = [](double value, double step) {
+        return static_cast<long long>(llround(value / (step > 0.0 ? step : 1.0)));
+    };
+
+    ostringstream key;
+    key << hex << setw(16) << setfill('0') << menuHash << dec
+        << '/' << bucket(goal[Nutrient::Calories], calorieStep) << 'x' << calorieStep;
+    for (int i = Nutrient::Calories + 1; i < MACRO_COUNT; i++) {
+        key << '/' << bucket(goal[i], gramStep);
+    }
+    key << 'x' << gramStep;
+    return key.str();
+}
+
+bool PlanCache::lookup(const string& key, Entry& out) {
+    lock_guard<mutex> lock(cacheMutex);
+    auto it = slots.find(key);
+    if (it == slots.end()) {
+        counters.misses++;
+        dirty = true;
+        return false;
+    }
+
+    touch(it->second);
+    counters.hits++;
+    out = it->second.entry;
+    dirty = true;
+    return true;
+}
+
+void PlanCache::store(const string& key, const Entry& entry) {
+    lock_guard<mutex> lock(cacheMutex);
+    if (capacity == 0) {
+        return;
+    }
+
+    auto it = slots.find(key);
+    if (it != slots.end()) {
+        it->second.entry = entry;
+        touch(it->second);
+    } else {
+        recency.push_front(key);
+        slots[key] = Slot{entry, recency.begin()};
+    }
+    evict();
+    dirty = true;
+    if (++unsavedStores >= SAVE_EVERY) {
+        save();
+    }
+}
+
+void PlanCache::setDeferred(bool defer) {
+    lock_guard<mutex> lock(cacheMutex);
+    deferred = defer;
+    if (!deferred && dirty) {
+        save();
+    }
+}
+
+PlanCache::Stats PlanCache::stats() const {
+    lock_guard<mutex> lock(cacheMutex);
+    Stats result = counters;
+    result.size = slots.size();
+    return result;
+}
+
+void PlanCache::load() {
+    ifstream file(path);
+    if (!file.is_open()) {
+        return;
+    }
+
+    // Entries by their saved recency rank, least recent first.
+    multimap<uint64_t, string> byRank;
+    string line;
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string tag;
+        getline(fields, tag, '\t');
+
+        if (tag == "stats") {
+            fields >> counters.hits >> counters.misses >> counters.evictions;
+            continue;
+        }
+        if (tag != "entry") {
+            continue;
+        }
+
+        string key, plans;
+        Slot slot;
+        uint64_t lastUsed = 0;
+        int optimal = 0;
+        getline(fields, key, '\t');
+        if (!(fields >> lastUsed >> slot.entry.objective >> slot.entry.gap >> optimal)) {
+            continue;
+        }
+        slot.entry.optimal = optimal != 0;
+        fields >> ws;
+        getline(fields, plans);
+
+        // Plans are ';'-separated lists of "index:servings" pairs.
+        istringstream planStream(plans);
+        string planText;
+        while (getline(planStream, planText, ';')) {
+            vector<pair<int, double>> plan;
+            istringstream pickStream(planText);
+            string pick;
+            while (getline(pickStream, pick, ',')) {
+                size_t colon = pick.find(':');
+                if (colon == string::npos) continue;
+                try {
+                    plan.push_back({stoi(pick.substr(0, colon)), stod(pick.substr(colon + 1))});
+                } catch (...) {
+                }
+            }
+            if (!plan.empty()) {
+                slot.entry.plans.push_back(plan);
+            }
+        }
+        if (!key.empty() && !slot.entry.plans.empty() && !slots.count(key)) {
+            slots[key] = slot;
+            byRank.insert({lastUsed, key});
+        }
+    }
+
+    for (const auto& ranked : byRank) {
+        recency.push_front(ranked.second);
+        slots[ranked.second].used = recency.begin();
+    }
+}
+
+void PlanCache::save() {
+    if (path.empty()) {
+        return;
+    }
+    if (deferred) {
+        dirty = true;
+        return;
+    }
+    dirty = false;
+    unsavedStores = 0;
+
+    error_code ec;
+    fs::path parent = fs::path(path).parent_path();
+    if (!parent.empty()) {
+        fs::create_directories(parent, ec);
+    }
+
+    string tempPath = path + ".tmp";
+    {
+        ofstream file(tempPath);
+        if (!file.is_open()) {
+            return;
+        }
+        file << "stats\t" << counters.hits << ' ' << counters.misses << ' '
+             << counters.evictions << "\n";
+        file << setprecision(17);
+        uint64_t rank = 0;
+        for (auto key = recency.rbegin(); key != recency.rend(); ++key) {
+            const Entry& entry = slots[*key].entry;
+            file << "entry\t" << *key << '\t' << ++rank << ' '
+                 << entry.objective << ' ' << entry.gap << ' '
+                 << (entry.optimal ? 1 : 0) << '\t';
+            for (size_t p = 0; p < entry.plans.size(); p++) {
+                if (p > 0) file << ';';
+                for (size_t k = 0; k < entry.plans[p].size(); k++) {
+                    if (k > 0) file << ',';
+                    file << entry.plans[p][k].first << ':' << entry.plans[p][k].second;
+                }
+            }
+            file << "\n";
+        }
+    }
+    rename(tempPath.c_str(), path.c_str());
+}
@@ -0,0 +1,121 @@
+#ifndef PLANCACHE_H
+#define PLANCACHE_H
+
+#include "PlanningEngine.h"
+#include "User.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Persistent LRU cache of meal plans. Keys combine a content hash of the
+// simplified menu with the meal targets quantized to a fixed resolution,
+// so users with nearly identical budgets share one solve. The cache is
+// stored as a tab-separated file, rewritten after every SAVE_EVERY stores
+// and when the cache is destroyed; other changes stay in memory until then.
+class PlanCache {
+public:
+    // Stores between rewrites of the cache file.
+    static const std::size_t SAVE_EVERY = 16;
+
+    // One cached solve: ranked plans as (menu index, servings) pairs plus
+    // the solve outcome reported with them.
+    struct Entry {
+        std::vector<std::vector<std::pair<int, double>>> plans;
+        double objective = 0.0;
+        double gap = 0.0;
+        bool optimal = false;
+    };
+
+    // Lookup counters, persisted with the cache.
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t size = 0;
+    };
+
+private:
+    struct Slot {
+        Entry entry;
+        // Position of the key in recency.
+        std::list<std::string>::iterator used;
+    };
+
+    std::string path;
+    std::size_t capacity;
+    std::map<std::string, Slot> slots;
+    // Keys, most recently used first.
+    std::list<std::string> recency;
+    Stats counters;
+    bool deferred;
+    bool dirty;
+    // Stores since the file was last written.
+    std::size_t unsavedStores;
+    mutable std::mutex cacheMutex;
+
+    // Reads the cache file, if any; unreadable lines are skipped.
+    void load();
+
+    // Marks key most recently used.
+    void touch(Slot& slot);
+
+    // Drops least recently used entries beyond the capacity; returns true
+    // if any were dropped.
+    bool evict();
+
+    // Writes the cache to a temporary file and renames it into place, or
+    // only marks it dirty while saves are deferred.
+    void save();
+
+public:
+    // Creates an empty, unbacked cache; configure() attaches a file.
+    PlanCache();
+
+    // Writes out changes not yet saved.
+    ~PlanCache();
+
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    // Attaches the cache to a file (loading it if the path changed) and
+    // sets the entry limit, evicting least recently used entries if needed.
+    void configure(const std::string& filepath, std::size_t maxEntries);
+
+    // Returns the content hash of a simplified menu: item names,
+    // stations, and nutrients, in order.
+    static std::uint64_t hashMenu(const std::vector<FoodItem>& menu);
+
+    // Mixes the items a diet filter excludes into a menu hash, so users
+    // with different filters never share plans. An empty mask, or one
+    // excluding nothing, leaves the hash unchanged.
+    static std::uint64_t hashExclusions(std::uint64_t menuHash,
+                                        const std::vector<bool>& excluded);
+
+    // Builds a key from a menu hash and a planning goal, with calories
+    // rounded to calorieStep and every other nutrient to gramStep
+    // planning units.
+    static std::string makeKey(std::uint64_t menuHash, const MacroVector& goal,
+                               double calorieStep, double gramStep);
+
+    // Copies the entry for key into out and marks it most recently used;
+    // returns false (and counts a miss) if there is none. The new order and
+    // counters are saved with the next write of the file.
+    bool lookup(const std::string& key, Entry& out);
+
+    // Inserts or replaces the entry for key, writing the cache file once
+    // SAVE_EVERY stores have accumulated.
+    void store(const std::string& key, const Entry& entry);
+
+    // While deferred, changes stay in memory; turning deferral off writes
+    // them out once. Batch planning uses this to avoid a rewrite per store.
+    void setDeferred(bool defer);
+
+    // Returns the hit, miss, and eviction counts and the entry count.
+    Stats stats() const;
+};
+
+#endif
@@ -0,0 +1,1349 @@
+#include "PlanningEngine.h"
+#include "BatchEvaluator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// One solve's view of a menu: the candidate items gathered from the
+// shared menu model, plus the goal-dependent linear term.
+struct PlanModel {
+    int n;
+    // Menu index of each candidate.
+    vector<int> menuIndex;
+    // Item-major macro matrix: a[j * MACRO_COUNT + i] is macro i of item j.
+    vector<double> a;
+    // Gram matrix of the candidates, row-major n x n.
+    vector<double> gram;
+    // Squared norm of each item's macro vector (the Gram diagonal).
+    vector<double> norm2;
+    // Linear term a_j . g of each item.
+    vector<double> linear;
+    MacroVector goal;
+    // Lipschitz constant of the gradient of ||Ax - g||^2.
+    double lipschitz;
+    // Vectorized scorer for batches of candidate plans.
+    BatchEvaluator evaluator;
+    PlanSettings settings;
+};
+
+// Returns the dot product of item j's macros with a macro vector.
+static double itemDot(const PlanModel& m, int j, const MacroVector& v) {
+    const double* aj = &m.a[j * MACRO_COUNT];
+    double sum = 0.0;
+    forEachNutrient<MACRO_COUNT>([&](size_t i) { sum += aj[i] * v[i]; });
+    return sum;
+}
+
+// Returns the squared Euclidean norm of a macro vector.
+static double norm2Of(const MacroVector& v) {
+    return v.squaredNorm();
+}
+
+// Returns the dot product of two macro vectors.
+static double dotOf(const MacroVector& u, const MacroVector& v) {
+    return u.dot(v);
+}
+
+// Gathers the candidates' rows and Gram entries from the shared menu
+// model; only the linear term depends on the goal.
+static PlanModel buildModel(const MenuModel& menu, const MacroVector& goal,
+                            const vector<int>& candidates,
+                            const PlanSettings& settings) {
+    PlanModel m;
+    m.n = static_cast<int>(candidates.size());
+    m.menuIndex = candidates;
+    m.goal = goal;
+    m.lipschitz = menu.lipschitz;
+    m.settings = settings;
+    m.a.resize(m.n * MACRO_COUNT);
+    m.gram.resize(m.n * m.n);
+    m.norm2.resize(m.n);
+    m.linear.resize(m.n);
+
+    size_t menuSize = menu.items.size();
+    vector<MacroVector> rows;
+    for (int j = 0; j < m.n; j++) {
+        const MacroVector& item = menu.items[candidates[j]];
+        rows.push_back(item);
+        forEachNutrient<MACRO_COUNT>([&](size_t i) { m.a[j * MACRO_COUNT + i] = item[i]; });
+        for (int k = 0; k < m.n; k++) {
+            m.gram[j * m.n + k] = menu.gram[candidates[j] * menuSize + candidates[k]];
+        }
+        m.norm2[j] = m.gram[j * m.n + j];
+        m.linear[j] = dotOf(item, goal);
+    }
+    m.evaluator = BatchEvaluator(rows, goal);
+    return m;
+}
+
+// Lower-bounds min ||fixed + sum_j a_j x_j - g||^2 over 0 <= x_j <= upper
+// for the given free items. Runs accelerated projected gradient from the
+// warm start x (indexed by item, updated in place), then turns the final
+// residual z into a Lagrangian bound that is valid for any z:
+//   -||z||^2 - 2 z.(g - fixed) + 2 * upper * sum_j min(0, a_j.z).
+static double boxRelaxation(const PlanModel& m, const MacroVector& fixed,
+                            const int* freeItems, int freeCount,
+                            vector<double>& x, int iterations) {
+    double upper = m.settings.servingStep * m.settings.maxLevel;
+    double step = 1.0 / m.lipschitz;
+
+    vector<double> y(x);
+    double t = 1.0;
+    MacroVector z;
+
+    auto residualAt = [&](const vector<double>& point) {
+        z = fixed - m.goal;
+        for (int f = 0; f < freeCount; f++) {
+            int j = freeItems[f];
+            const double* aj = &m.a[j * MACRO_COUNT];
+            forEachNutrient<MACRO_COUNT>([&](size_t i) { z[i] += aj[i] * point[j]; });
+        }
+    };
+
+    for (int it = 0; it < iterations; it++) {
+        residualAt(y);
+        double tNext = (1.0 + sqrt(1.0 + 4.0 * t * t)) / 2.0;
+        double momentum = (t - 1.0) / tNext;
+        for (int f = 0; f < freeCount; f++) {
+            int j = freeItems[f];
+            double grad = 2.0 * itemDot(m, j, z);
+            double next = min(max(y[j] - step * grad, 0.0), upper);
+            y[j] = next + momentum * (next - x[j]);
+            x[j] = next;
+        }
+        t = tNext;
+    }
+
+    residualAt(x);
+    double bound = -norm2Of(z);
+    forEachNutrient<MACRO_COUNT>([&](size_t i) { bound -= 2.0 * z[i] * (m.goal[i] - fixed[i]); });
+    for (int f = 0; f < freeCount; f++) {
+        bound += 2.0 * upper * min(0.0, itemDot(m, freeItems[f], z));
+    }
+
+    // Items are non-negative, so any macro already over its goal stays over.
+    double overshoot = 0.0;
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        double over = fixed[i] - m.goal[i];
+        if (over > 0.0) {
+            overshoot += over * over;
+        }
+    }
+
+    return max(max(bound, overshoot), 0.0);
+}
+
+// Incumbent plan, lower bound, stop flag, and ranked alternatives shared
+// by one solve.
+class SharedSearch {
+private:
+    mutex bestMutex;
+    vector<int> bestLevels;
+    string bestStrategy;
+    vector<double> relaxed;
+    atomic<double> best;
+    atomic<double> bound;
+    atomic<bool> stopFlag;
+    atomic<bool> proven;
+    atomic<bool> timedOut;
+    atomic<long long> nodes;
+    Clock::time_point deadline;
+    // When the search stops for good once the incumbent is proven but the
+    // alternatives pool is not yet full, as Clock ticks.
+    atomic<Clock::rep> poolEnd;
+    int poolTimeMs;
+    // End of the current strategy's time slice in single-threaded solves.
+    Clock::time_point phaseEnd;
+    double absGap;
+    double relGap;
+
+    // Best distinct plans seen so far, best first, and the objective a
+    // plan must beat to enter: the empty plan's until the pool is full,
+    // then the worst pooled plan's. offer() checks it without the lock.
+    vector<RankedPlan> pool;
+    atomic<double> poolCutoff;
+    size_t poolSize;
+    int minDifference;
+
+    // Returns true if the pool holds all the alternatives it wants.
+    bool poolFull() const { return poolSize <= 1 || pool.size() >= poolSize; }
+
+    // Returns true if two plans are too similar to both be alternatives.
+    bool conflicts(const vector<int>& p, const vector<int>& q) const {
+        if (minDifference <= 0) {
+            return p == q;
+        }
+        int difference = 0;
+        for (size_t j = 0; j < p.size(); j++) {
+            if ((p[j] > 0) != (q[j] > 0)) difference++;
+        }
+        return difference < minDifference;
+    }
+
+    // Adds a plan to the pool unless a similar plan is at least as good;
+    // similar worse plans make way for it. Caller holds bestMutex.
+    void addAlternative(const vector<int>& levels, double objective) {
+        for (const auto& plan : pool) {
+            if (plan.objective <= objective && conflicts(plan.levels, levels)) {
+                return;
+            }
+        }
+        pool.erase(remove_if(pool.begin(), pool.end(),
+                             [&](const RankedPlan& plan) { return conflicts(plan.levels, levels); }),
+                   pool.end());
+        auto at = upper_bound(pool.begin(), pool.end(), objective,
+                              [](double o, const RankedPlan& plan) { return o < plan.objective; });
+        pool.insert(at, RankedPlan{levels, objective});
+        if (pool.size() > poolSize) {
+            pool.pop_back();
+        }
+        if (pool.size() == poolSize) {
+            poolCutoff = pool.back().objective;
+            if (proven.load()) {
+                stopFlag = true;
+            }
+        }
+    }
+
+    // Marks the incumbent proven. The search stops then if the pool is
+    // full; otherwise it gets poolTimeMs more to fill it.
+    void markProven() {
+        bool wasProven = proven.exchange(true);
+        lock_guard<mutex> lock(bestMutex);
+        if (poolFull()) {
+            stopFlag = true;
+        } else if (!wasProven) {
+            poolEnd = (Clock::now() + chrono::milliseconds(poolTimeMs)).time_since_epoch().count();
+        }
+    }
+
+    // Marks the incumbent proven once it is within the gap of the bound.
+    void checkGap() {
+        double b = best.load();
+        if (b - bound.load() <= absGap + relGap * b) {
+            markProven();
+        }
+    }
+
+public:
+    // Starts from the empty plan, which is always feasible.
+    SharedSearch(const PlanModel& m, Clock::time_point deadlineAt)
+        : bestLevels(m.n, 0), bestStrategy("empty"),
+          best(norm2Of(m.goal)), bound(0.0), stopFlag(false), proven(false),
+          timedOut(false), nodes(0), deadline(deadlineAt),
+          poolEnd(numeric_limits<Clock::rep>::max()),
+          poolTimeMs(m.settings.alternativesTimeMs), phaseEnd(deadlineAt),
+          absGap(m.settings.absGap), relGap(m.settings.relGap),
+          poolCutoff(norm2Of(m.goal)),
+          poolSize(static_cast<size_t>(max(m.settings.alternatives, 1))),
+          minDifference(m.settings.minItemDifference) {
+        checkGap();
+    }
+
+    // Returns the current incumbent objective.
+    double incumbent() const { return best.load(); }
+
+    // Returns a copy of the current incumbent plan.
+    vector<int> incumbentLevels() {
+        lock_guard<mutex> lock(bestMutex);
+        return bestLevels;
+    }
+
+    // Records a plan as an alternative if it ranks, and as the incumbent
+    // if it beats it; returns true if it became the incumbent. Plans that
+    // beat neither never take the lock.
+    bool offer(const vector<int>& levels, double objective,
+               const char* strategy) {
+        bool pooled = poolSize > 1 && objective < poolCutoff.load();
+        if (objective >= best.load() && !pooled) {
+            return false;
+        }
+        {
+            lock_guard<mutex> lock(bestMutex);
+            if (pooled) {
+                addAlternative(levels, objective);
+            }
+            if (objective >= best.load()) {
+                return false;
+            }
+            bestLevels = levels;
+            bestStrategy = strategy;
+            best = objective;
+        }
+        checkGap();
+        return true;
+    }
+
+    // Raises the shared lower bound if lb improves it.
+    void raiseBound(double lb) {
+        double current = bound.load();
+        while (lb > current && !bound.compare_exchange_weak(current, lb)) {
+        }
+        checkGap();
+    }
+
+    // Counts one branch-and-bound node.
+    void countNode() { nodes.fetch_add(1, memory_order_relaxed); }
+
+    // Records the continuous relaxation point for later warm starts.
+    void setRelaxed(const vector<double>& x) {
+        lock_guard<mutex> lock(bestMutex);
+        relaxed = x;
+    }
+
+    // Called when branch-and-bound has exhausted its tree: every pruned
+    // subtree was at least best * (1 - relGap) - absGap.
+    void markExhausted() {
+        raiseBound(best.load() * (1.0 - relGap) - absGap);
+        markProven();
+    }
+
+    // Returns true once the search should stop (proven or out of time),
+    // or once the current strategy's time slice is used up.
+    bool shouldStop() {
+        if (stopFlag.load()) {
+            return true;
+        }
+        Clock::time_point now = Clock::now();
+        if (now.time_since_epoch().count() >= poolEnd.load()) {
+            stopFlag = true;
+            return true;
+        }
+        if (now >= deadline) {
+            timedOut = true;
+            stopFlag = true;
+            return true;
+        }
+        return now >= phaseEnd;
+    }
+
+    // Starts a strategy's time slice; it ends at end or the deadline.
+    void beginPhase(Clock::time_point end) {
+        phaseEnd = min(end, deadline);
+    }
+
+    // Returns the time point a fraction of the way to the deadline.
+    Clock::time_point sliceOf(double fraction) const {
+        Clock::time_point now = Clock::now();
+        return now + chrono::duration_cast<Clock::duration>((deadline - now) * fraction);
+    }
+
+    // Packages the incumbent and bound into a solution.
+    PlanSolution result() {
+        lock_guard<mutex> lock(bestMutex);
+        PlanSolution solution;
+        solution.levels = bestLevels;
+        solution.objective = best.load();
+        solution.lowerBound = min(bound.load(), solution.objective);
+        solution.optimal = proven.load();
+        solution.timedOut = timedOut.load() && !solution.optimal;
+        solution.strategy = bestStrategy;
+        solution.nodes = nodes.load();
+        solution.relaxed = relaxed;
+        solution.alternatives = pool;
+        if (solution.alternatives.empty() || solution.alternatives[0].levels != bestLevels) {
+            solution.alternatives.insert(solution.alternatives.begin(),
+                                         RankedPlan{bestLevels, solution.objective});
+            if (solution.alternatives.size() > poolSize) {
+                solution.alternatives.pop_back();
+            }
+        }
+        return solution;
+    }
+};
+
+// Serving levels plus the half-gradient G = A^T (Ax - g), updated through
+// Gram columns so that scoring a move costs O(1) regardless of how many
+// macros each item carries.
+struct SearchState {
+    vector<int> levels;
+    vector<double> gradient;
+    double objective;
+    int chosen;
+};
+
+// Initializes a search state from a full set of serving levels.
+static void initState(const PlanModel& m, SearchState& s,
+                      const vector<int>& levels) {
+    s.levels = levels;
+    s.chosen = 0;
+
+    MacroVector residual;
+    forEachNutrient<MACRO_COUNT>([&](size_t i) { residual[i] = -m.goal[i]; });
+    for (int j = 0; j < m.n; j++) {
+        if (levels[j] == 0) continue;
+        s.chosen++;
+        double x = m.settings.servingStep * levels[j];
+        forEachNutrient<MACRO_COUNT>([&](size_t i) { residual[i] += m.a[j * MACRO_COUNT + i] * x; });
+    }
+
+    s.gradient.resize(m.n);
+    for (int j = 0; j < m.n; j++) {
+        s.gradient[j] = itemDot(m, j, residual);
+    }
+    s.objective = norm2Of(residual);
+}
+
+// Returns true if item j may move to the given level under the item cap.
+static bool moveAllowed(const PlanModel& m, const SearchState& s, int j,
+                        int level) {
+    return !(s.levels[j] == 0 && level > 0 && s.chosen >= m.settings.maxItems);
+}
+
+// Returns the objective change of moving item j to a new level.
+static double moveDelta(const PlanModel& m, const SearchState& s, int j,
+                        int level) {
+    double delta = m.settings.servingStep * (level - s.levels[j]);
+    return 2.0 * delta * s.gradient[j] + delta * delta * m.norm2[j];
+}
+
+// Moves item j to a new serving level and updates the gradient along
+// Gram column j.
+static void applyMove(const PlanModel& m, SearchState& s, int j, int level) {
+    double delta = m.settings.servingStep * (level - s.levels[j]);
+    s.objective += 2.0 * delta * s.gradient[j] + delta * delta * m.norm2[j];
+    if (s.levels[j] == 0 && level > 0) s.chosen++;
+    if (s.levels[j] > 0 && level == 0) s.chosen--;
+    s.levels[j] = level;
+
+    const double* column = &m.gram[j * m.n];
+    for (int k = 0; k < m.n; k++) {
+        s.gradient[k] += delta * column[k];
+    }
+}
+
+// Applies the best improving single-item level change, if any.
+static bool improveOnce(const PlanModel& m, SearchState& s) {
+    int bestItem = -1;
+    int bestLevel = 0;
+    double bestDelta = -1e-9;
+
+    for (int j = 0; j < m.n; j++) {
+        for (int level = 0; level <= m.settings.maxLevel; level++) {
+            if (level == s.levels[j] || !moveAllowed(m, s, j, level)) continue;
+            double delta = moveDelta(m, s, j, level);
+            if (delta < bestDelta) {
+                bestDelta = delta;
+                bestItem = j;
+                bestLevel = level;
+            }
+        }
+    }
+
+    if (bestItem < 0) {
+        return false;
+    }
+    applyMove(m, s, bestItem, bestLevel);
+    return true;
+}
+
+// Applies the best improving swap of a chosen item for an unchosen one.
+// Removing item out shifts every gradient entry by one Gram column entry,
+// so each (out, in) pair is scored in O(1).
+static bool improveSwap(const PlanModel& m, SearchState& s) {
+    int bestOut = -1, bestIn = -1, bestLevel = 0;
+    double bestObjective = s.objective - 1e-9;
+    double step = m.settings.servingStep;
+
+    for (int out = 0; out < m.n; out++) {
+        if (s.levels[out] == 0) continue;
+
+        double removed = -step * s.levels[out];
+        double base = s.objective + 2.0 * removed * s.gradient[out]
+                      + removed * removed * m.norm2[out];
+        const double* column = &m.gram[out * m.n];
+
+        for (int in = 0; in < m.n; in++) {
+            if (in == out || s.levels[in] != 0 || m.norm2[in] <= 0.0) continue;
+
+            // Best continuous level for the incoming item, then its neighbors.
+            double grad = s.gradient[in] + removed * column[in];
+            double ideal = -grad / (step * m.norm2[in]);
+            int centre = static_cast<int>(lround(ideal));
+            for (int level = centre - 1; level <= centre + 1; level++) {
+                if (level < 1 || level > m.settings.maxLevel) continue;
+                double delta = step * level;
+                double objective = base + 2.0 * delta * grad + delta * delta * m.norm2[in];
+                if (objective < bestObjective) {
+                    bestObjective = objective;
+                    bestOut = out;
+                    bestIn = in;
+                    bestLevel = level;
+                }
+            }
+        }
+    }
+
+    if (bestOut < 0) {
+        return false;
+    }
+    applyMove(m, s, bestOut, 0);
+    applyMove(m, s, bestIn, bestLevel);
+    return true;
+}
+
+// Descends to a local optimum of single-item changes and swaps, then
+// recomputes the objective exactly to drop accumulated rounding error.
+static void descend(const PlanModel& m, SearchState& s, SharedSearch& shared) {
+    while (!shared.shouldStop()) {
+        if (improveOnce(m, s)) continue;
+        if (!improveSwap(m, s)) break;
+    }
+    vector<int> levels = s.levels;
+    initState(m, s, levels);
+}
+
+// Rounds a continuous serving vector to levels, keeping the maxItems
+// largest entries. With an RNG, rounds each fraction up with probability
+// equal to the fraction; without one, rounds to nearest.
+static vector<int> roundRelaxation(const PlanModel& m, const vector<double>& x,
+                                   mt19937* rng) {
+    vector<int> levels(m.n, 0);
+    uniform_real_distribution<double> coin(0.0, 1.0);
+
+    for (int j = 0; j < m.n; j++) {
+        double scaled = x[j] / m.settings.servingStep;
+        int level = rng ? static_cast<int>(floor(scaled)) : static_cast<int>(lround(scaled));
+        if (rng && coin(*rng) < scaled - floor(scaled)) {
+            level++;
+        }
+        levels[j] = min(max(level, 0), m.settings.maxLevel);
+    }
+
+    vector<int> chosen;
+    for (int j = 0; j < m.n; j++) {
+        if (levels[j] > 0) chosen.push_back(j);
+    }
+    if (static_cast<int>(chosen.size()) > m.settings.maxItems) {
+        sort(chosen.begin(), chosen.end(),
+             [&](int p, int q) { return x[p] > x[q]; });
+        for (size_t k = m.settings.maxItems; k < chosen.size(); k++) {
+            levels[chosen[k]] = 0;
+        }
+    }
+    return levels;
+}
+
+// Solves the continuous relaxation for a global lower bound, then rounds
+// it (first to nearest, then randomly) and polishes the roundings. A warm
+// start point close to the new optimum needs far fewer iterations. Random
+// roundings are drawn in batches and scored with the vectorized evaluator
+// so only the most promising one per batch pays for a full descent.
+static void runRelaxation(const PlanModel& m, SharedSearch& shared,
+                          const vector<double>& start) {
+    const int BATCH_SIZE = 16;
+
+    vector<int> all(m.n);
+    for (int j = 0; j < m.n; j++) all[j] = j;
+
+    MacroVector zero{};
+    vector<double> x = start;
+    bool warm = any_of(x.begin(), x.end(), [](double v) { return v > 0.0; });
+    double lb = boxRelaxation(m, zero, all.data(), m.n, x, warm ? 500 : 3000);
+    shared.raiseBound(lb);
+    shared.setRelaxed(x);
+
+    SearchState s;
+    initState(m, s, roundRelaxation(m, x, nullptr));
+    descend(m, s, shared);
+    shared.offer(s.levels, s.objective, "relaxation");
+
+    mt19937 rng(12345);
+    vector<vector<int>> roundings(BATCH_SIZE);
+    vector<double> servings(static_cast<size_t>(BATCH_SIZE) * m.n);
+    vector<double> scores(BATCH_SIZE);
+    while (!shared.shouldStop()) {
+        for (int b = 0; b < BATCH_SIZE; b++) {
+            roundings[b] = roundRelaxation(m, x, &rng);
+            for (int j = 0; j < m.n; j++) {
+                servings[b * m.n + j] = m.settings.servingStep * roundings[b][j];
+            }
+        }
+        m.evaluator.evaluate(servings.data(), BATCH_SIZE, scores.data());
+        int best = static_cast<int>(min_element(scores.begin(), scores.end()) - scores.begin());
+
+        initState(m, s, roundings[best]);
+        descend(m, s, shared);
+        shared.offer(s.levels, s.objective, "relaxation");
+    }
+}
+
+// Iterated local search: descends, then repeatedly kicks the best plan
+// this worker has seen with a few random level changes.
+static void runLocalSearch(const PlanModel& m, SharedSearch& shared,
+                           unsigned seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pickItem(0, m.n - 1);
+    uniform_int_distribution<int> pickLevel(0, m.settings.maxLevel);
+
+    SearchState current;
+    initState(m, current, shared.incumbentLevels());
+    descend(m, current, shared);
+    shared.offer(current.levels, current.objective, "local-search");
+
+    SearchState trial;
+    int kicks = 0;
+    while (!shared.shouldStop()) {
+        // Periodically restart from the shared incumbent.
+        if (++kicks % 64 == 0) {
+            initState(m, current, shared.incumbentLevels());
+        }
+
+        trial = current;
+        int moves = 1 + static_cast<int>(rng() % 3);
+        for (int k = 0; k < moves; k++) {
+            int j = pickItem(rng);
+            int level = pickLevel(rng);
+            if (moveAllowed(m, trial, j, level)) {
+                applyMove(m, trial, j, level);
+            }
+        }
+        descend(m, trial, shared);
+
+        shared.offer(trial.levels, trial.objective, "local-search");
+        if (trial.objective < current.objective) {
+            current = trial;
+        }
+    }
+}
+
+// Depth-first branch-and-bound over items ordered by decreasing norm.
+// Each node bounds its subtree with the box relaxation of the free items.
+class BranchAndBound {
+private:
+    const PlanModel& m;
+    SharedSearch& shared;
+    vector<int> order;
+    vector<int> levels;
+    MacroVector fixed;
+    // Warm-start relaxation point for each depth, indexed by item.
+    vector<vector<double>> relax;
+    bool aborted;
+
+    // Explores the subtree whose first depth items are fixed.
+    void dfs(int depth, int chosen) {
+        if (aborted || shared.shouldStop()) {
+            aborted = true;
+            return;
+        }
+        shared.countNode();
+
+        // The partial plan with every remaining item skipped is feasible;
+        // it only differs from the parent's when the last item was chosen.
+        if (depth == 0 || levels[order[depth - 1]] > 0) {
+            MacroVector r;
+            r = fixed - m.goal;
+            shared.offer(levels, norm2Of(r), "branch-and-bound");
+        }
+
+        if (depth == m.n || chosen == m.settings.maxItems) {
+            return;
+        }
+
+        double cutoff = shared.incumbent() * (1.0 - m.settings.relGap) - m.settings.absGap;
+        vector<double>& x = relax[depth + 1];
+        x = relax[depth];
+        int iterations = depth == 0 ? 3000 : 20;
+        double lb = boxRelaxation(m, fixed, order.data() + depth, m.n - depth, x, iterations);
+        if (depth == 0) {
+            shared.raiseBound(lb);
+        }
+        if (lb >= cutoff) {
+            return;
+        }
+
+        // Try levels nearest to the relaxed serving first.
+        int j = order[depth];
+        double target = x[j] / m.settings.servingStep;
+        vector<int> candidates;
+        for (int level = 0; level <= m.settings.maxLevel; level++) {
+            candidates.push_back(level);
+        }
+        sort(candidates.begin(), candidates.end(), [&](int p, int q) {
+            return fabs(p - target) < fabs(q - target);
+        });
+
+        const double* aj = &m.a[j * MACRO_COUNT];
+        for (int level : candidates) {
+            double amount = m.settings.servingStep * level;
+            levels[j] = level;
+            forEachNutrient<MACRO_COUNT>([&](size_t i) { fixed[i] += aj[i] * amount; });
+            dfs(depth + 1, chosen + (level > 0 ? 1 : 0));
+            forEachNutrient<MACRO_COUNT>([&](size_t i) { fixed[i] -= aj[i] * amount; });
+            levels[j] = 0;
+            if (aborted) return;
+        }
+    }
+
+public:
+    BranchAndBound(const PlanModel& model, SharedSearch& sharedSearch)
+        : m(model), shared(sharedSearch), order(model.n), levels(model.n, 0),
+          fixed{}, relax(model.n + 1, vector<double>(model.n, 0.0)),
+          aborted(false) {
+        for (int j = 0; j < m.n; j++) order[j] = j;
+        sort(order.begin(), order.end(),
+             [&](int p, int q) { return m.norm2[p] > m.norm2[q]; });
+    }
+
+    // Searches the whole tree, or until the shared search stops.
+    void run() {
+        dfs(0, 0);
+        if (!aborted) {
+            shared.markExhausted();
+        }
+    }
+};
+
+// Packages the shared incumbent with levels mapped back onto the menu.
+static PlanSolution menuSolution(const PlanModel& m, SharedSearch& shared,
+                                 size_t menuSize) {
+    PlanSolution solution = shared.result();
+    vector<int> levels(menuSize, 0);
+    for (int j = 0; j < m.n; j++) {
+        levels[m.menuIndex[j]] = solution.levels[j];
+    }
+    solution.levels = levels;
+    for (auto& plan : solution.alternatives) {
+        vector<int> planLevels(menuSize, 0);
+        for (int j = 0; j < m.n; j++) {
+            planLevels[m.menuIndex[j]] = plan.levels[j];
+        }
+        plan.levels = planLevels;
+    }
+    if (!solution.relaxed.empty()) {
+        vector<double> relaxed(menuSize, 0.0);
+        for (int j = 0; j < m.n; j++) {
+            relaxed[m.menuIndex[j]] = solution.relaxed[j];
+        }
+        solution.relaxed = relaxed;
+    }
+    return solution;
+}
+
+// Gathers a menu-indexed warm start's plan and relaxation point onto the
+// candidates; items that are no longer candidates drop out.
+static void gatherWarmStart(const PlanModel& m, const PlanSolution* warm,
+                            vector<int>& levels, vector<double>& relaxed) {
+    levels.assign(m.n, 0);
+    relaxed.assign(m.n, 0.0);
+    if (!warm) {
+        return;
+    }
+    int chosen = 0;
+    for (int j = 0; j < m.n; j++) {
+        size_t k = m.menuIndex[j];
+        if (k < warm->levels.size() && warm->levels[k] > 0 && chosen < m.settings.maxItems) {
+            levels[j] = min(warm->levels[k], m.settings.maxLevel);
+            chosen++;
+        }
+        if (k < warm->relaxed.size()) {
+            relaxed[j] = warm->relaxed[k];
+        }
+    }
+}
+
+// Re-scores the warm plan for the new goal, polishes it, and offers it
+// as the first incumbent so every strategy prunes against it at once.
+static void seedWarmStart(const PlanModel& m, SharedSearch& shared,
+                          const vector<int>& levels) {
+    SearchState state;
+    initState(m, state, levels);
+    descend(m, state, shared);
+    shared.offer(state.levels, state.objective, "warm-start");
+}
+
+// Creates the engine and its worker pool. The pool always has room for
+// one worker per strategy so a long-running strategy cannot starve the
+// others on machines with fewer cores.
+PlanningEngine::PlanningEngine(unsigned threadCount)
+    : pool(max(threadCount == 0 ? thread::hardware_concurrency() : threadCount, 3u)) {}
+
+// Returns true if b is a positive multiple of a; sets scale so b = scale * a.
+static bool scaledCopy(const MacroVector& a, const MacroVector& b,
+                       double& scale) {
+    double aa = norm2Of(a);
+    double bb = norm2Of(b);
+    if (aa <= 0.0 || bb <= 0.0) {
+        return false;
+    }
+    double ab = dotOf(a, b);
+    // Cauchy-Schwarz is tight only for parallel vectors.
+    if (ab <= 0.0 || ab * ab < aa * bb * (1.0 - 1e-12)) {
+        return false;
+    }
+    scale = ab / aa;
+    return true;
+}
+
+// Hashes the macro matrix with 64-bit FNV-1a over the raw doubles.
+static uint64_t hashItems(const vector<MacroVector>& items) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const auto& item : items) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(item.data());
+        for (size_t b = 0; b < sizeof(double) * MACRO_COUNT; b++) {
+            hash ^= bytes[b];
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+// Builds the Gram matrix, Lipschitz constant, and the goal-independent
+// presolve groupings for one menu.
+static shared_ptr<const MenuModel> buildMenuModel(const vector<MacroVector>& items,
+                                                  uint64_t version) {
+    auto menu = make_shared<MenuModel>();
+    int n = static_cast<int>(items.size());
+    menu->version = version;
+    menu->items = items;
+    menu->gram.resize(static_cast<size_t>(n) * n);
+    menu->duplicateOf.assign(n, -1);
+    menu->ray.assign(n, -1);
+    menu->rayScale.assign(n, 1.0);
+    menu->sameCalories.resize(n);
+
+    double outer[MACRO_COUNT][MACRO_COUNT] = {};
+    for (int j = 0; j < n; j++) {
+        for (int k = j; k < n; k++) {
+            double value = dotOf(items[j], items[k]);
+            menu->gram[j * n + k] = value;
+            menu->gram[k * n + j] = value;
+        }
+        for (int r = 0; r < MACRO_COUNT; r++) {
+            for (int c = 0; c < MACRO_COUNT; c++) {
+                outer[r][c] += items[j][r] * items[j][c];
+            }
+        }
+    }
+
+    // Power iteration on the MACRO_COUNT x MACRO_COUNT matrix A A^T for its
+    // largest eigenvalue.
+    MacroVector v;
+    v.fill(1.0);
+    double lambda = 0.0;
+    for (int it = 0; it < 60; it++) {
+        MacroVector w{};
+        for (int r = 0; r < MACRO_COUNT; r++) {
+            for (int c = 0; c < MACRO_COUNT; c++) {
+                w[r] += outer[r][c] * v[c];
+            }
+        }
+        lambda = sqrt(norm2Of(w));
+        if (lambda <= 0.0) {
+            break;
+        }
+        forEachNutrient<MACRO_COUNT>([&](size_t i) { v[i] = w[i] / lambda; });
+    }
+    // Pad the estimate so the projected-gradient step never overshoots.
+    menu->lipschitz = max(2.0 * lambda * 1.05, 1e-9);
+
+    for (int j = 0; j < n; j++) {
+        for (int k = 0; k < j && menu->duplicateOf[j] < 0; k++) {
+            if (items[k] == items[j]) {
+                menu->duplicateOf[j] = k;
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            if (k != j && fabs(items[k][Nutrient::Calories] - items[j][Nutrient::Calories]) <= 0.5) {
+                menu->sameCalories[j].push_back(k);
+            }
+        }
+        if (menu->ray[j] >= 0) continue;
+        for (int k = j; k < n; k++) {
+            double scale;
+            if (menu->ray[k] < 0 && scaledCopy(items[j], items[k], scale)) {
+                menu->ray[k] = j;
+                menu->rayScale[k] = scale;
+            }
+        }
+    }
+
+    return menu;
+}
+
+// Looks up the menu model by content hash, building it on a miss and
+// evicting the least recently used model when the cache is full.
+shared_ptr<const MenuModel> PlanningEngine::prepareMenu(
+    const vector<MacroVector>& items) {
+    uint64_t version = hashItems(items);
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        for (auto it = menuCache.begin(); it != menuCache.end(); ++it) {
+            if ((*it)->version == version && (*it)->items == items) {
+                menuCache.splice(menuCache.begin(), menuCache, it);
+                return menuCache.front();
+            }
+        }
+    }
+
+    shared_ptr<const MenuModel> menu = buildMenuModel(items, version);
+
+    lock_guard<mutex> lock(cacheMutex);
+    menuCache.push_front(menu);
+    if (menuCache.size() > MENU_CACHE_SIZE) {
+        menuCache.pop_back();
+    }
+    return menu;
+}
+
+// Races branch-and-bound, relaxation rounding, and local search on the
+// pool, or runs them in turn on this thread when settings ask for it.
+PlanSolution PlanningEngine::solvePortfolio(const MenuModel& menu,
+                                            const MacroVector& goal,
+                                            const vector<int>& candidates,
+                                            const PlanSettings& settings,
+                                            const PlanSolution* warmStart) {
+    PlanModel model = buildModel(menu, goal, candidates, settings);
+    Clock::time_point deadline =
+        Clock::now() + chrono::milliseconds(settings.timeLimitMs);
+    SharedSearch shared(model, deadline);
+
+    vector<int> warmLevels;
+    vector<double> warmRelaxed;
+    gatherWarmStart(model, warmStart, warmLevels, warmRelaxed);
+    if (warmStart && model.n > 0) {
+        seedWarmStart(model, shared, warmLevels);
+    }
+
+    if (model.n > 0 && !shared.shouldStop() && settings.singleThreaded) {
+        // The relaxation and branch-and-bound each get a slice of what is
+        // left; local search runs to the deadline.
+        shared.beginPhase(shared.sliceOf(0.3));
+        runRelaxation(model, shared, warmRelaxed);
+        shared.beginPhase(shared.sliceOf(0.5));
+        BranchAndBound(model, shared).run();
+        shared.beginPhase(deadline);
+        runLocalSearch(model, shared, 7919u);
+    } else if (model.n > 0 && !shared.shouldStop()) {
+        // The relaxation goes first so the others start with a bound and a
+        // rounded incumbent; leftover workers run independent local searches.
+        vector<future<void>> jobs;
+        jobs.push_back(pool.submit([&]() { runRelaxation(model, shared, warmRelaxed); }));
+        unsigned searchers = pool.size() > 2 ? pool.size() - 2 : 1;
+        for (unsigned s = 0; s < searchers; s++) {
+            jobs.push_back(pool.submit(
+                [&, s]() { runLocalSearch(model, shared, 7919u * (s + 1)); }));
+        }
+        jobs.push_back(pool.submit([&]() { BranchAndBound(model, shared).run(); }));
+
+        for (auto& job : jobs) {
+            job.get();
+        }
+    }
+
+    return menuSolution(model, shared, menu.items.size());
+}
+
+// Returns how far a macro sum strays from the goal's direction.
+static double offProfile(const MacroVector& sum, const MacroVector& goal) {
+    double t = min(max(dotOf(sum, goal) / max(norm2Of(goal), 1e-12), 0.0), 1.0);
+    return norm2Of(MacroVector(sum).addScaled(goal, -t));
+}
+
+// Returns the macro grid cell of a sum, one twelfth of the goal wide.
+static array<long, MACRO_COUNT> macroCell(const MacroVector& sum,
+                                          const MacroVector& goal, double cells) {
+    array<long, MACRO_COUNT> cell;
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        double width = max(fabs(goal[i]), 1.0) / cells;
+        cell[i] = static_cast<long>(floor(sum[i] / width));
+    }
+    return cell;
+}
+
+// A few items from one station, with their combined macros.
+struct SubPlan {
+    // (candidate index, level) pairs.
+    vector<pair<int, int>> picks;
+    MacroVector sum;
+};
+
+// Enumerates one- and two-item sub-plans of a station's most promising
+// items and keeps a compact, diverse subset: plans landing in the same
+// macro grid cell collapse to the one with fewer items, and the survivors
+// are ranked by how far they stray from the goal's direction, since
+// in-profile pieces add up well. Stops enumerating once the search stops.
+static vector<SubPlan> stationSubplans(const PlanModel& m, vector<int> items,
+                                       SharedSearch& shared) {
+    const PlanSettings& st = m.settings;
+    vector<SubPlan> all;
+    all.push_back(SubPlan{{}, MacroVector{}});
+
+    // Pairs grow quadratically, so only the items whose best single
+    // serving comes closest to the goal take part.
+    if (items.size() > static_cast<size_t>(st.stationCandidates)) {
+        vector<pair<double, int>> ranked;
+        for (int j : items) {
+            double best = numeric_limits<double>::infinity();
+            for (int level = 1; level <= st.maxLevel; level++) {
+                MacroVector r = m.goal;
+                forEachNutrient<MACRO_COUNT>([&](size_t i) {
+                    r[i] -= m.a[j * MACRO_COUNT + i] * st.servingStep * level;
+                });
+                best = min(best, norm2Of(r));
+            }
+            ranked.push_back({best, j});
+        }
+        partial_sort(ranked.begin(), ranked.begin() + st.stationCandidates, ranked.end());
+        items.clear();
+        for (int k = 0; k < st.stationCandidates; k++) {
+            items.push_back(ranked[k].second);
+        }
+    }
+
+    auto add = [&](int j, int level, SubPlan plan) {
+        plan.picks.push_back({j, level});
+        forEachNutrient<MACRO_COUNT>([&](size_t i) {
+            plan.sum[i] += m.a[j * MACRO_COUNT + i] * st.servingStep * level;
+        });
+        return plan;
+    };
+    for (size_t p = 0; p < items.size() && !shared.shouldStop(); p++) {
+        for (int lp = 1; lp <= st.maxLevel; lp++) {
+            SubPlan single = add(items[p], lp, all[0]);
+            all.push_back(single);
+            if (st.maxItems < 2) continue;
+            for (size_t q = p + 1; q < items.size(); q++) {
+                for (int lq = 1; lq <= st.maxLevel; lq++) {
+                    all.push_back(add(items[q], lq, single));
+                }
+            }
+        }
+    }
+
+    map<array<long, MACRO_COUNT>, size_t> cells;
+    vector<SubPlan> kept;
+    for (auto& plan : all) {
+        auto found = cells.insert({macroCell(plan.sum, m.goal, 12.0), kept.size()});
+        if (found.second) {
+            kept.push_back(move(plan));
+        } else if (plan.picks.size() < kept[found.first->second].picks.size()) {
+            kept[found.first->second] = move(plan);
+        }
+    }
+
+    // The empty sub-plan always survives so a station can be skipped.
+    sort(kept.begin() + 1, kept.end(), [&](const SubPlan& p, const SubPlan& q) {
+        return offProfile(p.sum, m.goal) < offProfile(q.sum, m.goal);
+    });
+    if (kept.size() > static_cast<size_t>(st.stationSubplans) + 1) {
+        kept.resize(st.stationSubplans + 1);
+    }
+    return kept;
+}
+
+// Picks one sub-plan per station: a beam search over stations whose
+// partial plans are deduplicated on a macro grid, pruned when a macro
+// already overshoots by more than the best plan's error (items only
+// add), and capped by distance from the goal's direction. Block
+// coordinate descent then re-picks each station with the others fixed.
+static vector<int> solveMaster(const PlanModel& m,
+                               const vector<vector<SubPlan>>& subplans,
+                               SharedSearch& shared) {
+    struct Node {
+        MacroVector sum;
+        int count;
+        int parent;
+        int choice;
+        double offProfile;
+    };
+    auto error = [&](const MacroVector& sum) {
+        MacroVector r;
+        r = sum - m.goal;
+        return norm2Of(r);
+    };
+    auto overshoot = [&](const MacroVector& sum) {
+        double total = 0.0;
+        for (int i = 0; i < MACRO_COUNT; i++) {
+            double over = sum[i] - m.goal[i];
+            if (over > 0.0) total += over * over;
+        }
+        return total;
+    };
+
+    size_t stations = subplans.size();
+    vector<vector<Node>> layers(stations + 1);
+    layers[0].push_back(Node{MacroVector{}, 0, -1, -1, 0.0});
+    double bestError = error(MacroVector{});
+    for (size_t s = 0; s < stations && !shared.shouldStop(); s++) {
+        map<array<long, MACRO_COUNT>, size_t> cells;
+        vector<Node>& next = layers[s + 1];
+        for (size_t p = 0; p < layers[s].size(); p++) {
+            const Node& node = layers[s][p];
+            for (size_t c = 0; c < subplans[s].size(); c++) {
+                const SubPlan& plan = subplans[s][c];
+                int count = node.count + static_cast<int>(plan.picks.size());
+                if (count > m.settings.maxItems) continue;
+                Node child{node.sum, count, static_cast<int>(p), static_cast<int>(c), 0.0};
+                child.sum += plan.sum;
+                if (overshoot(child.sum) >= bestError) continue;
+                bestError = min(bestError, error(child.sum));
+                child.offProfile = offProfile(child.sum, m.goal);
+
+                auto found = cells.insert({macroCell(child.sum, m.goal, 24.0), next.size()});
+                if (found.second) {
+                    next.push_back(child);
+                } else if (child.count < next[found.first->second].count) {
+                    next[found.first->second] = child;
+                }
+            }
+        }
+        if (next.size() > static_cast<size_t>(m.settings.beamWidth)) {
+            nth_element(next.begin(), next.begin() + m.settings.beamWidth, next.end(),
+                        [](const Node& p, const Node& q) { return p.offProfile < q.offProfile; });
+            next.resize(m.settings.beamWidth);
+        }
+    }
+
+    // Every node is a complete plan (later stations may pick nothing).
+    vector<int> choice(stations, 0);
+    size_t bestLayer = 0;
+    int best = 0;
+    for (size_t s = 0; s <= stations; s++) {
+        for (size_t p = 0; p < layers[s].size(); p++) {
+            if (error(layers[s][p].sum) < error(layers[bestLayer][best].sum)) {
+                bestLayer = s;
+                best = static_cast<int>(p);
+            }
+        }
+    }
+    for (size_t s = bestLayer; s > 0; s--) {
+        choice[s - 1] = layers[s][best].choice;
+        best = layers[s][best].parent;
+    }
+
+    MacroVector total{};
+    int count = 0;
+    for (size_t s = 0; s < stations; s++) {
+        const SubPlan& plan = subplans[s][choice[s]];
+        total += plan.sum;
+        count += static_cast<int>(plan.picks.size());
+    }
+    for (bool improved = true; improved && !shared.shouldStop();) {
+        improved = false;
+        for (size_t s = 0; s < stations; s++) {
+            const SubPlan& current = subplans[s][choice[s]];
+            MacroVector rest = total;
+            rest -= current.sum;
+            int restCount = count - static_cast<int>(current.picks.size());
+
+            double bestError = error(total) - 1e-9;
+            int bestChoice = -1;
+            for (size_t c = 0; c < subplans[s].size(); c++) {
+                const SubPlan& plan = subplans[s][c];
+                if (restCount + static_cast<int>(plan.picks.size()) > m.settings.maxItems) continue;
+                MacroVector sum = rest;
+                sum += plan.sum;
+                double e = error(sum);
+                if (e < bestError) {
+                    bestError = e;
+                    bestChoice = static_cast<int>(c);
+                }
+            }
+            if (bestChoice >= 0) {
+                choice[s] = bestChoice;
+                const SubPlan& plan = subplans[s][bestChoice];
+                total = rest + plan.sum;
+                count = restCount + static_cast<int>(plan.picks.size());
+                improved = true;
+            }
+        }
+    }
+    return choice;
+}
+
+// Builds per-station sub-plans (on the pool unless single-threaded),
+// solves the master problem, and polishes the combined plan with
+// item-level local search.
+PlanSolution PlanningEngine::solveDecomposed(const MenuModel& menu,
+                                             const MacroVector& goal,
+                                             const vector<int>& candidates,
+                                             const vector<int>& stations,
+                                             const PlanSettings& settings,
+                                             const PlanSolution* warmStart) {
+    PlanModel model = buildModel(menu, goal, candidates, settings);
+    Clock::time_point deadline =
+        Clock::now() + chrono::milliseconds(settings.timeLimitMs);
+    SharedSearch shared(model, deadline);
+    if (model.n == 0) {
+        return menuSolution(model, shared, menu.items.size());
+    }
+
+    vector<int> warmLevels;
+    vector<double> x;
+    gatherWarmStart(model, warmStart, warmLevels, x);
+    if (warmStart) {
+        seedWarmStart(model, shared, warmLevels);
+    }
+
+    map<int, vector<int>> byStation;
+    for (int j = 0; j < model.n; j++) {
+        byStation[stations[model.menuIndex[j]]].push_back(j);
+    }
+    vector<vector<SubPlan>> subplans;
+    if (settings.singleThreaded) {
+        for (const auto& entry : byStation) {
+            subplans.push_back(stationSubplans(model, entry.second, shared));
+        }
+    } else {
+        vector<future<vector<SubPlan>>> jobs;
+        for (const auto& entry : byStation) {
+            const vector<int>& items = entry.second;
+            jobs.push_back(pool.submit(
+                [&model, &items, &shared]() { return stationSubplans(model, items, shared); }));
+        }
+        for (auto& job : jobs) {
+            subplans.push_back(job.get());
+        }
+    }
+
+    vector<int> choice = solveMaster(model, subplans, shared);
+    vector<int> levels(model.n, 0);
+    for (size_t s = 0; s < subplans.size(); s++) {
+        for (const auto& pick : subplans[s][choice[s]].picks) {
+            levels[pick.first] = pick.second;
+        }
+    }
+
+    SearchState state;
+    initState(model, state, levels);
+    shared.offer(state.levels, state.objective, "decomposition");
+    descend(model, state, shared);
+    shared.offer(state.levels, state.objective, "decomposition");
+
+    // The relaxation over all candidates bounds the whole problem.
+    vector<int> all(model.n);
+    for (int j = 0; j < model.n; j++) all[j] = j;
+    bool warm = any_of(x.begin(), x.end(), [](double v) { return v > 0.0; });
+    shared.raiseBound(boxRelaxation(model, MacroVector{}, all.data(), model.n, x,
+                                    warm ? 500 : 3000));
+    shared.setRelaxed(x);
+
+    return menuSolution(model, shared, menu.items.size());
+}
+
+// Bounds the whole item set with the box relaxation, starting from the
+// menu-indexed point relaxed when one is given.
+double PlanningEngine::relaxationBound(const MenuModel& menu,
+                                       const MacroVector& goal,
+                                       const vector<int>& items,
+                                       const PlanSettings& settings,
+                                       const vector<double>& relaxed) {
+    PlanModel model = buildModel(menu, goal, items, settings);
+    vector<int> all(model.n);
+    vector<double> x(model.n, 0.0);
+    bool warm = false;
+    for (int j = 0; j < model.n; j++) {
+        all[j] = j;
+        if (static_cast<size_t>(items[j]) < relaxed.size()) {
+            x[j] = relaxed[items[j]];
+            warm = warm || x[j] > 0.0;
+        }
+    }
+    return boxRelaxation(model, MacroVector{}, all.data(), model.n, x, warm ? 500 : 3000);
+}
+
+// Picks candidates with the rules described in the header, using the
+// menu model's precomputed duplicate, ray, and same-calorie groupings.
+// Only the exclusions are hard constraints. The other rules are heuristics
+// that trade a little optimality for a much smaller search: even an item
+// over the calorie budget or a second copy of an item can lower the error,
+// so a plan proven optimal over the kept items is optimal for that set only.
+PresolveResult PlanningEngine::presolve(const MenuModel& menu,
+                                        const MacroVector& goal,
+                                        const PlanSettings& settings) {
+    PresolveResult result;
+    int n = static_cast<int>(menu.items.size());
+    vector<bool> removed(n, false);
+
+    // Excluded items go first, so an identical item can stand in for one.
+    // Half a serving (the smallest choice) must fit the calorie budget;
+    // identical macro vectors merge into their first occurrence.
+    for (int j = 0; j < n; j++) {
+        if (j < static_cast<int>(settings.excluded.size()) && settings.excluded[j]) {
+            removed[j] = true;
+            result.excluded++;
+        } else if (settings.servingStep * menu.items[j][Nutrient::Calories] > goal[Nutrient::Calories]) {
+            removed[j] = true;
+            result.overBudget++;
+        } else if (menu.duplicateOf[j] >= 0 && !removed[menu.duplicateOf[j]]) {
+            removed[j] = true;
+            result.merged++;
+        }
+    }
+
+    // Same-calorie dominance against the goal's per-calorie macro profile:
+    // k dominates j if it is at least as close to the profile in every
+    // macro and strictly closer in one. Items with no macros are dropped.
+    vector<bool> dominated(n, false);
+    for (int j = 0; j < n; j++) {
+        if (removed[j]) continue;
+        const MacroVector& aj = menu.items[j];
+        if (norm2Of(aj) <= 0.0) {
+            dominated[j] = true;
+            continue;
+        }
+        if (goal[Nutrient::Calories] <= 0.0) continue;
+
+        for (int k : menu.sameCalories[j]) {
+            if (removed[k] || dominated[k]) continue;
+            const MacroVector& ak = menu.items[k];
+
+            bool noWorse = true;
+            bool better = false;
+            for (int i = 1; i < MACRO_COUNT; i++) {
+                double profile = aj[Nutrient::Calories] * goal[i] / goal[Nutrient::Calories];
+                double dj = fabs(aj[i] - profile);
+                double dk = fabs(ak[i] - profile);
+                if (dk > dj) noWorse = false;
+                if (dk < dj) better = true;
+            }
+            if (noWorse && better) {
+                dominated[j] = true;
+                break;
+            }
+        }
+    }
+
+    // Scaled copies lie on one ray in macro space; keep the item whose
+    // serving levels land closest to the goal's projection onto that ray.
+    vector<int> bestOnRay(n, -1);
+    vector<double> bestDistance(n, numeric_limits<double>::infinity());
+    for (int j = 0; j < n; j++) {
+        if (removed[j] || dominated[j] || menu.ray[j] < 0) continue;
+        int base = menu.ray[j];
+        const MacroVector& a = menu.items[base];
+        double along = dotOf(goal, a) / norm2Of(a);
+
+        double distance = numeric_limits<double>::infinity();
+        for (int level = 1; level <= settings.maxLevel; level++) {
+            distance = min(distance,
+                           fabs(along - menu.rayScale[j] * settings.servingStep * level));
+        }
+        if (distance < bestDistance[base]) {
+            bestDistance[base] = distance;
+            bestOnRay[base] = j;
+        }
+    }
+
+    for (int j = 0; j < n; j++) {
+        if (removed[j]) continue;
+        if (dominated[j] || (menu.ray[j] >= 0 && bestOnRay[menu.ray[j]] != j)) {
+            result.dominated++;
+        } else {
+            result.keptItems.push_back(j);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,234 @@
+#ifndef PLANNINGENGINE_H
+#define PLANNINGENGINE_H
+
+#include "NutrientVector.h"
+#include "ThreadPool.h"
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Number of nutrients the planner matches, taken from the front of
+// Nutrient::Index: 4 plans calories and macros; building with
+// PLAN_NUTRIENTS=7 also plans fiber, sugar, and sodium.
+#ifndef PLAN_NUTRIENTS
+#define PLAN_NUTRIENTS 4
+#endif
+const int MACRO_COUNT = PLAN_NUTRIENTS;
+static_assert(MACRO_COUNT > Nutrient::Fats && MACRO_COUNT <= static_cast<int>(NUTRIENT_COUNT),
+              "PLAN_NUTRIENTS must cover the four macros and fit Nutrient::Index");
+
+// One planning vector, in the same order as solver.py's matrix rows.
+typedef NutrientVector<MACRO_COUNT> MacroVector;
+
+// Converts amounts of every nutrient into a planning vector: the planned
+// nutrients, each multiplied by its planScale.
+inline MacroVector planVector(const Nutrients& amounts) {
+    MacroVector out = amounts.head<MACRO_COUNT>();
+    forEachNutrient<MACRO_COUNT>([&](std::size_t i) { out[i] *= NUTRIENT_INFO[i].planScale; });
+    return out;
+}
+
+// Menu-only structures shared by every solve against one menu version.
+// Building one costs O(n^2); each user's solve then only supplies the
+// goal-dependent linear term A^T g.
+struct MenuModel {
+    // Content hash of the macro matrix, used as the cache key.
+    std::uint64_t version;
+
+    // Per-serving macro vector of each item.
+    std::vector<MacroVector> items;
+
+    // Gram matrix A^T A, row-major n x n.
+    std::vector<double> gram;
+
+    // 2 * lambda_max(A A^T), the Lipschitz constant of the objective's
+    // gradient. It is valid for any subset of the items.
+    double lipschitz;
+
+    // Index of the first item with an identical macro vector, or -1.
+    std::vector<int> duplicateOf;
+
+    // Items that are positive multiples of each other share a ray id;
+    // rayScale[j] is item j's length relative to the ray's first item.
+    std::vector<int> ray;
+    std::vector<double> rayScale;
+
+    // For each item, the other items within half a calorie of it.
+    std::vector<std::vector<int>> sameCalories;
+};
+
+// Limits and stopping rules shared by every planning strategy.
+struct PlanSettings {
+    // Maximum number of distinct items in one meal.
+    int maxItems = 15;
+
+    // Servings are chosen from servingStep * {1, ..., maxLevel}.
+    int maxLevel = 6;
+    double servingStep = 0.5;
+
+    // The search stops once best - bound <= absGap + relGap * best.
+    double absGap = 1e-6;
+    double relGap = 1e-3;
+
+    // Wall-clock budget for one solve, in milliseconds.
+    int timeLimitMs = 200;
+
+    // Station decomposition: items per station that sub-plans are built
+    // from (those whose best single serving lands closest to the goal),
+    // sub-plans kept per station, and partial plans kept per stage of the
+    // master search.
+    int stationCandidates = 16;
+    int stationSubplans = 48;
+    int beamWidth = 512;
+
+    // Number of ranked plans to collect during the search (1 = best only).
+    // Collected plans must differ in at least minItemDifference chosen
+    // items; with 0 they only need different serving levels.
+    int alternatives = 1;
+    int minItemDifference = 0;
+
+    // Once the best plan is proven, the search keeps filling the
+    // alternatives pool for at most this many milliseconds.
+    int alternativesTimeMs = 20;
+
+    // Run the strategies one after another on the calling thread, each
+    // with a slice of the time limit, instead of racing them on the
+    // engine's pool. Batch planning sets this so its own workers never
+    // wait on the shared pool.
+    bool singleThreaded = false;
+
+    // Items presolve must drop regardless of the goal, by menu index
+    // (empty means none). Multi-day planning uses this to keep items
+    // within their repetition limits.
+    std::vector<bool> excluded;
+};
+
+// One plan and its squared macro error.
+struct RankedPlan {
+    std::vector<int> levels;
+    double objective;
+};
+
+// Best plan found by a solve and the bound that certifies it.
+struct PlanSolution {
+    // Serving level per menu item; 0 means the item is not chosen.
+    std::vector<int> levels;
+
+    // Squared macro error ||Ax - g||^2 of the plan.
+    double objective;
+
+    // Best proven lower bound on the optimal objective.
+    double lowerBound;
+
+    // True when the search proved the plan optimal within the gap limits.
+    bool optimal;
+
+    // True when the time limit cut the search short.
+    bool timedOut;
+
+    // Name of the strategy that found the returned plan.
+    std::string strategy;
+
+    // Branch-and-bound nodes explored (0 if no strategy branched).
+    long long nodes = 0;
+
+    // The best distinct plans seen during the search, best first; the
+    // first is the returned plan. Holds up to settings.alternatives.
+    std::vector<RankedPlan> alternatives;
+
+    // Continuous relaxation point per menu item, kept so a later solve
+    // for a nearby goal can warm-start from it (empty if not computed).
+    std::vector<double> relaxed;
+};
+
+// Candidate items left after presolve and why the others were dropped.
+struct PresolveResult {
+    // Menu indices of the items that remain candidates.
+    std::vector<int> keptItems;
+
+    // Items dropped because settings.excluded rules them out.
+    int excluded = 0;
+
+    // Items dropped because half a serving exceeds the calorie budget.
+    int overBudget = 0;
+
+    // Items merged into an earlier item with an identical macro vector.
+    int merged = 0;
+
+    // Items removed because another item dominates them.
+    int dominated = 0;
+};
+
+// Native mixed-integer planner that races several strategies on one menu.
+class PlanningEngine {
+private:
+    ThreadPool pool;
+
+    // Recently prepared menus, most recently used first.
+    std::list<std::shared_ptr<const MenuModel>> menuCache;
+    std::mutex cacheMutex;
+
+public:
+    // Number of prepared menus kept in the cache.
+    static constexpr size_t MENU_CACHE_SIZE = 16;
+
+    // Creates an engine with the given number of worker threads
+    // (0 means one per hardware thread, and never fewer than three).
+    explicit PlanningEngine(unsigned threadCount = 0);
+
+    // Returns the menu model for these items, building it only if no
+    // cached model has the same content hash.
+    std::shared_ptr<const MenuModel> prepareMenu(
+        const std::vector<MacroVector>& items);
+
+    // Runs exact branch-and-bound, relaxation-plus-rounding, and local
+    // search concurrently over the candidate items. All strategies share
+    // one incumbent and lower bound, and stop as soon as the incumbent is
+    // proven optimal or the time limit passes.
+    //
+    // warmStart, if given, is an earlier solution on the same menu for a
+    // nearby goal: its plan is re-scored for the new goal, polished, and
+    // seeds the incumbent, and its relaxation point seeds the relaxation.
+    PlanSolution solvePortfolio(const MenuModel& menu, const MacroVector& goal,
+                                const std::vector<int>& candidates,
+                                const PlanSettings& settings,
+                                const PlanSolution* warmStart = nullptr);
+
+    // Solves by station decomposition. Each station's candidates are
+    // reduced to a small set of sub-plans (at most two items each), a beam
+    // search over stations picks one sub-plan per station under the item
+    // cap, block coordinate descent refines the choice, and item-level
+    // local search polishes the result. stations holds a station id per
+    // menu item; work grows linearly with the number of stations.
+    // warmStart seeds the incumbent as in solvePortfolio.
+    PlanSolution solveDecomposed(const MenuModel& menu, const MacroVector& goal,
+                                 const std::vector<int>& candidates,
+                                 const std::vector<int>& stations,
+                                 const PlanSettings& settings,
+                                 const PlanSolution* warmStart = nullptr);
+
+    // Picks the candidate items for one goal. Drops items whose smallest
+    // serving exceeds the calorie budget, merges identical macro vectors,
+    // removes same-calorie items that are farther from the goal's macro
+    // profile in every macro than another item, and keeps only the item
+    // that best reaches the goal along each set of scaled copies. Only
+    // settings.excluded is exact; the other rules are heuristics, so a plan
+    // proven optimal over the kept items need not be optimal for the menu.
+    static PresolveResult presolve(const MenuModel& menu, const MacroVector& goal,
+                                   const PlanSettings& settings);
+
+    // Returns a lower bound on the squared macro error of any plan over
+    // the given menu items from their box relaxation, which ignores the
+    // item cap and integer levels. relaxed, if not empty, is a menu-indexed
+    // relaxation point to start from.
+    static double relaxationBound(const MenuModel& menu, const MacroVector& goal,
+                                  const std::vector<int>& items,
+                                  const PlanSettings& settings,
+                                  const std::vector<double>& relaxed);
+};
+
+#endif
@@ -1,7 +1,9 @@
 #include "ProfileUI.h"
 #include "UIUtils.h"
+#include "DietIndex.h"
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
 using namespace std;
 
@@ -30,18 +32,24 @@ void ProfileUI::showProfileEditor() {
          << (currentUser.macroRatio.protein * 100) << "%\n";
     cout << "       " << GREEN << "Carbs"   << RESET << ": " << (currentUser.macroRatio.carbs * 100) << "%\n";
     cout << "       " << CYAN   << "Fats"   << RESET << ": " << (currentUser.macroRatio.fats * 100) << "%\n";
+    cout << "       Fiber: " << currentUser.fiberGoal << "g, Sugar: " << currentUser.sugarGoal
+         << "g, Sodium: " << currentUser.sodiumGoal << "mg\n";
+    cout << "       Diet filter: "
+         << (currentUser.dietFilter.empty() ? "none" : currentUser.dietFilter) << "\n";
     cout << "\n";
     UIUtils::printSeparator();
     cout << "\n";
     cout << "     What would you like to update?\n\n";
     cout << "     " << YELLOW << "[1]" << RESET << " Update calorie goal\n";
     cout << "     " << YELLOW << "[2]" << RESET << " Update macro ratios\n";
-    cout << "     " << YELLOW << "[3]" << RESET << " Change password\n";
-    cout << "     " << YELLOW << "[4]" << RESET << " Return to main menu\n";
+    cout << "     " << YELLOW << "[3]" << RESET << " Update fiber, sugar, and sodium goals\n";
+    cout << "     " << YELLOW << "[4]" << RESET << " Update diet filter\n";
+    cout << "     " << YELLOW << "[5]" << RESET << " Change password\n";
+    cout << "     " << YELLOW << "[6]" << RESET << " Return to main menu\n";
     cout << "\n";
     UIUtils::printSeparator();
     cout << "\n";
-    cout << "  >> Enter your choice (1-4): ";
+    cout << "  >> Enter your choice (1-6): ";
     
     int choice;
     cin >> choice;
@@ -95,6 +103,72 @@ void ProfileUI::showProfileEditor() {
         UIUtils::waitForEnter();
 
     } else if (choice == 3) {
+        cout << "\n";
+        UIUtils::printSeparator();
+        cout << "\n";
+        cout << "     Enter new daily goals (Fiber g, Sugar g, Sodium mg)\n";
+        cout << "     Example: 28 50 2300\n";
+        cout << "\n";
+        cout << "  >> New goals: ";
+        cin >> currentUser.fiberGoal >> currentUser.sugarGoal >> currentUser.sodiumGoal;
+
+        auth.updateUser(currentUser);
+        cout << "\n";
+        UIUtils::printSeparator();
+        cout << "\n";
+        cout << "     " << GREEN << BOLD << "SUCCESS!" << RESET << " Goals updated to "
+             << fixed << setprecision(0) << currentUser.fiberGoal << "g fiber, "
+             << currentUser.sugarGoal << "g sugar, " << currentUser.sodiumGoal << "mg sodium.\n";
+        cout << "\n";
+        UIUtils::printSeparator();
+        UIUtils::waitForEnter();
+
+    } else if (choice == 4) {
+        cout << "\n";
+        UIUtils::printSeparator();
+        cout << "\n";
+        cout << "     Enter diets and ingredients to avoid, separated by commas\n";
+        cout << "     Example: vegan, no peanuts (leave blank to clear)\n";
+        cout << "\n";
+        cout << "  >> New filter: ";
+        string filter;
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        getline(cin, filter);
+
+        size_t first = filter.find_first_not_of(" \t");
+        size_t last = filter.find_last_not_of(" \t");
+        filter = first == string::npos ? "" : filter.substr(first, last - first + 1);
+
+        // A typo would otherwise be required as an icon and empty every menu.
+        DietFilter parsed = DietIndex::parseFilter(filter);
+        if (!parsed.unknownTerms.empty()) {
+            cout << "\n     " << RED << "Unknown filter term";
+            for (size_t k = 0; k < parsed.unknownTerms.size(); k++) {
+                cout << (k > 0 ? ", \"" : ": \"") << parsed.unknownTerms[k] << "\"";
+            }
+            cout << "." << RESET << "\n"
+                 << "     Use vegan, vegetarian, gluten free, an icon code (V, VG, GFI),\n"
+                 << "     or \"no X\" / \"X-free\" for ingredients. Filter unchanged.\n";
+            cout << "\n  Press ENTER...";
+            cin.get();
+            return;
+        }
+        currentUser.dietFilter = filter;
+
+        auth.updateUser(currentUser);
+        cout << "\n";
+        UIUtils::printSeparator();
+        cout << "\n";
+        cout << "     " << GREEN << BOLD << "SUCCESS!" << RESET << " Diet filter "
+             << (currentUser.dietFilter.empty() ? "cleared" : "set to " + currentUser.dietFilter)
+             << ".\n";
+        cout << "\n";
+        UIUtils::printSeparator();
+        // getline already consumed the newline waitForEnter would skip.
+        cout << "\n  Press ENTER...";
+        cin.get();
+
+    } else if (choice == 5) {
         string oldPass, newPass;
         cout << "\n";
         UIUtils::printSeparator();
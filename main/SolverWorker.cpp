@@ -0,0 +1,328 @@
+#include "SolverWorker.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Extra time a reply may take beyond the solve deadline: the first request
+// also pays for the worker's imports.
+static const int REPLY_GRACE_MS = 60000;
+
+// Request opcodes, reply status bytes, and solve outcomes; they must match
+// solver_worker.py.
+static const char OP_SOLVE = 2;
+static const char REPLY_OK = 0;
+static const uint8_t STATUS_OPTIMAL = 0;
+static const uint8_t STATUS_DEADLINE = 2;
+static const uint8_t STATUS_PRESOLVED = 3;
+
+// Appends value in little-endian byte order.
+static void putU32(string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out += static_cast<char>((value >> shift) & 0xff);
+    }
+}
+
+// Appends the IEEE 754 bits of value in little-endian byte order.
+static void putF64(string& out, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int shift = 0; shift < 64; shift += 8) {
+        out += static_cast<char>((bits >> shift) & 0xff);
+    }
+}
+
+// Reads a little-endian u32 at offset and advances it; false if truncated.
+static bool getU32(const string& in, size_t& offset, uint32_t& value) {
+    if (offset + 4 > in.size()) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(in[offset + i])) << (8 * i);
+    }
+    offset += 4;
+    return true;
+}
+
+// Reads a little-endian f64 at offset and advances it; false if truncated.
+static bool getF64(const string& in, size_t& offset, double& value) {
+    if (offset + 8 > in.size()) {
+        return false;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits |= static_cast<uint64_t>(static_cast<unsigned char>(in[offset + i])) << (8 * i);
+    }
+    memcpy(&value, &bits, sizeof(value));
+    offset += 8;
+    return true;
+}
+
+// Records how to launch the worker; it starts on the first request.
+SolverWorker::SolverWorker(const string& pythonPath, const string& scriptPath)
+    : python(pythonPath), script(scriptPath), pid(-1), toWorker(-1), fromWorker(-1),
+      restartCount(0) {}
+
+// Stops the worker process, if one is running.
+SolverWorker::~SolverWorker() {
+    lock_guard<mutex> lock(workerMutex);
+    stop();
+}
+
+#ifndef _WIN32
+
+// Held from pipe creation through fork, so where pipes cannot be created
+// close-on-exec atomically one worker's start never forks while another's
+// pipes are still inheritable.
+static mutex spawnMutex;
+
+// Creates a close-on-exec pipe: atomically with pipe2 on Linux, otherwise
+// with pipe and fcntl while the caller holds spawnMutex.
+static bool openPipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC) == 0;
+#else
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+// The pipes are close-on-exec from the start, so a child another thread
+// forks before this one finishes (menu.py runs via system()) never
+// inherits them; dup2 clears the flag on the worker's stdin and stdout.
+bool SolverWorker::start() {
+    lock_guard<mutex> spawnLock(spawnMutex);
+    int in[2], out[2];
+    if (!openPipe(in)) {
+        return false;
+    }
+    if (!openPipe(out)) {
+        close(in[0]);
+        close(in[1]);
+        return false;
+    }
+
+    pid_t child = fork();
+    if (child < 0) {
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+    if (child == 0) {
+        // Only async-signal-safe calls until exec.
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0) {
+            dup2(devNull, STDERR_FILENO);
+            close(devNull);
+        }
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        execl(python.c_str(), python.c_str(), "-u", script.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    close(in[0]);
+    close(out[1]);
+    toWorker = in[1];
+    fromWorker = out[0];
+    pid = child;
+
+    // Report a dead worker as a failed write instead of a signal.
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+}
+
+// Closing stdin asks the worker to exit; SIGTERM covers one that is busy.
+void SolverWorker::stop() {
+    if (toWorker >= 0) close(toWorker);
+    if (fromWorker >= 0) close(fromWorker);
+    toWorker = fromWorker = -1;
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    pid = -1;
+}
+
+// Reads exactly size bytes from the worker, retrying short reads and
+// interrupted calls; false at end of file, on an error, or at the deadline.
+bool SolverWorker::readBytes(char* out, size_t size,
+                             chrono::steady_clock::time_point deadline) {
+    size_t got = 0;
+    while (got < size) {
+        int waitMs = static_cast<int>(chrono::duration_cast<chrono::milliseconds>(
+            deadline - chrono::steady_clock::now()).count());
+        if (waitMs <= 0) {
+            return false;
+        }
+        pollfd ready = {fromWorker, POLLIN, 0};
+        int polled = poll(&ready, 1, waitMs);
+        if (polled < 0 && errno == EINTR) continue;
+        if (polled <= 0) {
+            return false;
+        }
+
+        ssize_t chunk = read(fromWorker, out + got, size - got);
+        if (chunk < 0 && errno == EINTR) continue;
+        if (chunk <= 0) {
+            return false;
+        }
+        got += static_cast<size_t>(chunk);
+    }
+    return true;
+}
+
+// Writes one request frame and reads the reply frame within timeoutMs;
+// reply gets the payload after the status byte.
+SolverWorker::Exchange SolverWorker::exchange(const string& request, string& reply,
+                                              int timeoutMs) {
+    string frame;
+    putU32(frame, static_cast<uint32_t>(request.size()));
+    frame += request;
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t wrote = write(toWorker, frame.data() + sent, frame.size() - sent);
+        if (wrote < 0 && errno == EINTR) continue;
+        if (wrote <= 0) {
+            return Exchange::Broken;
+        }
+        sent += static_cast<size_t>(wrote);
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    char header[4];
+    if (!readBytes(header, sizeof(header), deadline)) {
+        return Exchange::Broken;
+    }
+    size_t offset = 0;
+    uint32_t length = 0;
+    getU32(string(header, sizeof(header)), offset, length);
+    if (length == 0) {
+        return Exchange::Broken;
+    }
+    string payload(length, '\0');
+    if (!readBytes(&payload[0], length, deadline)) {
+        return Exchange::Broken;
+    }
+
+    reply = payload.substr(1);
+    return payload[0] == REPLY_OK ? Exchange::Ok : Exchange::Failed;
+}
+
+// Sends payload, starting the worker if needed; a broken exchange restarts
+// the worker and retries once.
+bool SolverWorker::request(const string& payload, string& reply, int timeoutMs) {
+    lock_guard<mutex> lock(workerMutex);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (pid <= 0 && !start()) {
+            return false;
+        }
+        Exchange outcome = exchange(payload, reply, timeoutMs);
+        if (outcome != Exchange::Broken) {
+#ifdef DEBUG
+            if (outcome == Exchange::Failed) {
+                cerr << "Solver worker error: " << reply << endl;
+            }
+#endif
+            return outcome == Exchange::Ok;
+        }
+        stop();
+        restartCount++;
+    }
+    return false;
+}
+
+#else
+
+// Windows builds run solver.py once per meal instead (see
+// MenuManager::planWithPython), so the worker never starts.
+bool SolverWorker::start() { return false; }
+void SolverWorker::stop() {}
+bool SolverWorker::readBytes(char*, size_t, chrono::steady_clock::time_point) {
+    return false;
+}
+SolverWorker::Exchange SolverWorker::exchange(const string&, string&, int) {
+    return Exchange::Broken;
+}
+bool SolverWorker::request(const string&, string&, int) { return false; }
+
+#endif
+
+// Encodes a SOLVE request, sends it, and decodes the reply into solution.
+bool SolverWorker::solve(const vector<MacroVector>& items, const MacroVector& goal,
+                         int deadlineMs, const string& formulation, Solution& solution) {
+    string payload(1, static_cast<char>(OP_SOLVE));
+    putU32(payload, static_cast<uint32_t>(items.size()));
+    putU32(payload, static_cast<uint32_t>(MACRO_COUNT));
+    putF64(payload, deadlineMs);
+    payload += static_cast<char>(formulation == "integer" ? 1 : 0);
+    for (double target : goal) {
+        putF64(payload, target);
+    }
+    for (const auto& item : items) {
+        for (double amount : item) {
+            putF64(payload, amount);
+        }
+    }
+
+    string reply;
+    if (!request(payload, reply, deadlineMs + REPLY_GRACE_MS)) {
+        solution.error = reply.empty() ? "solver worker did not answer" : reply;
+        return false;
+    }
+
+    size_t offset = 0;
+    if (offset >= reply.size()) {
+        solution.error = "empty solve reply";
+        return false;
+    }
+    uint8_t status = static_cast<uint8_t>(reply[offset++]);
+    uint32_t before = 0, after = 0, nodes = 0, count = 0;
+    if (!getF64(reply, offset, solution.objective) || !getF64(reply, offset, solution.gap)
+        || !getU32(reply, offset, before) || !getU32(reply, offset, after)
+        || !getF64(reply, offset, solution.buildMs) || !getF64(reply, offset, solution.solveMs)
+        || !getU32(reply, offset, nodes) || !getU32(reply, offset, count)) {
+        solution.error = "truncated solve reply";
+        return false;
+    }
+    solution.optimal = status == STATUS_OPTIMAL;
+    solution.presolvedOptimal = status == STATUS_PRESOLVED;
+    solution.deadlineHit = status == STATUS_DEADLINE;
+    solution.itemsBefore = static_cast<int>(before);
+    solution.itemsAfter = static_cast<int>(after);
+    solution.nodes = nodes;
+
+    solution.servings.clear();
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t index = 0;
+        double servings = 0.0;
+        if (!getU32(reply, offset, index) || !getF64(reply, offset, servings)
+            || index >= items.size()) {
+            solution.error = "bad item in solve reply";
+            return false;
+        }
+        solution.servings.push_back({static_cast<int>(index), servings});
+    }
+    return true;
+}
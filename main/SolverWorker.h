@@ -0,0 +1,94 @@
+#ifndef SOLVERWORKER_H
+#define SOLVERWORKER_H
+
+#include "PlanningEngine.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Long-lived solver_worker.py process that runs solver.py solves over a
+// pair of pipes, so the interpreter and its numpy and cvxpy imports load
+// once per session instead of once per meal.
+// Requests and replies are length-prefixed binary frames (see
+// solver_worker.py): solves send the nutrient matrix and goal and get item
+// indices and servings back, so neither side writes a file. The process
+// starts on the first request and is restarted if it dies or stops
+// answering. Not available on Windows, where callers keep running one
+// Python process per request.
+class SolverWorker {
+public:
+    // Outcome of one solve, with items referenced by their matrix row.
+    // Times are the worker's own: model build (presolve and compilation)
+    // and search. error explains a failed solve.
+    struct Solution {
+        std::vector<std::pair<int, double>> servings;
+        bool optimal = false;
+        bool presolvedOptimal = false;
+        bool deadlineHit = false;
+        double objective = 0.0;
+        double gap = 0.0;
+        int itemsBefore = 0;
+        int itemsAfter = 0;
+        double buildMs = 0.0;
+        double solveMs = 0.0;
+        long long nodes = 0;
+        std::string error;
+    };
+
+private:
+    std::string python;
+    std::string script;
+    int pid;
+    int toWorker;
+    int fromWorker;
+
+    int restartCount;
+    std::mutex workerMutex;
+
+    // Outcome of one request/reply exchange.
+    enum class Exchange { Ok, Failed, Broken };
+
+    // Forks and execs the worker with its stdin and stdout on pipes.
+    bool start();
+
+    // Closes the pipes and reaps the worker, killing it if needed.
+    void stop();
+
+    // Reads exactly size bytes before the deadline; false on EOF or timeout.
+    bool readBytes(char* out, std::size_t size,
+                   std::chrono::steady_clock::time_point deadline);
+
+    // Sends one request frame and reads the reply frame, without its
+    // status byte. An error reply is Failed; a dead or silent worker is
+    // Broken.
+    Exchange exchange(const std::string& request, std::string& reply, int timeoutMs);
+
+    // Runs a request, restarting the worker once if it is broken.
+    bool request(const std::string& payload, std::string& reply, int timeoutMs);
+
+public:
+    // Prepares a worker running script with the given interpreter; the
+    // process is not started until the first request.
+    SolverWorker(const std::string& pythonPath = "../.venv/bin/python",
+                 const std::string& scriptPath = "solver_worker.py");
+
+    // Stops the worker process.
+    ~SolverWorker();
+
+    SolverWorker(const SolverWorker&) = delete;
+    SolverWorker& operator=(const SolverWorker&) = delete;
+
+    // Solves for goal over the items' planning vectors with solver.py's
+    // formulation ("onehot" or "integer"); true on success, otherwise
+    // solution.error says why.
+    bool solve(const std::vector<MacroVector>& items, const MacroVector& goal,
+               int deadlineMs, const std::string& formulation, Solution& solution);
+
+    // Number of times the worker was restarted after dying.
+    int restarts() const { return restartCount; }
+};
+
+#endif
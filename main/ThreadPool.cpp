@@ -0,0 +1,50 @@
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Starts the worker threads; falls back to a single worker if the hardware
+// thread count is unknown.
+ThreadPool::ThreadPool(unsigned threadCount) : stopping(false) {
+    if (threadCount == 0) {
+        threadCount = thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+// Signals shutdown, lets workers drain the queue, and joins them.
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+// Waits for tasks and runs them until shutdown with an empty queue.
+void ThreadPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(queueMutex);
+            queueCv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
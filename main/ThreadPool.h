@@ -0,0 +1,54 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads that runs queued tasks in FIFO order.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    bool stopping;
+
+    // Pops and runs tasks until the pool is destroyed.
+    void workerLoop();
+
+public:
+    // Starts the given number of workers (0 means one per hardware thread).
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    // Finishes queued tasks, then joins all workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Returns the number of worker threads.
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Queues a callable and returns a future for its result.
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using R = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<R()>>(
+            std::forward<F>(task));
+        std::future<R> future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        queueCv.notify_one();
+        return future;
+    }
+};
+
+#endif
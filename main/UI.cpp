@@ -8,7 +8,7 @@
 using namespace std;
 
 // Constructs the root UI object and initializes sub-UIs with references.
-UI::UI() 
+UI::UI(const MenuManager::PlanOptions& planOptions)
     : menuManager(), 
       auth(), 
       currentUser(), 
@@ -18,6 +18,7 @@ UI::UI()
       loggerUI(menuManager, currentUser, auth),
       profileUI(currentUser, auth)
 {
+    menuManager.setPlanOptions(planOptions);
 }
 
 // Runs the top-level loop for welcome, login/registration, and exit.
@@ -103,21 +104,22 @@ void UI::showMainMenu() {
         UIUtils::printSeparator();
         
         int calPercent = (currentUser.calorieGoal > 0)
-            ? (totals.calories * 100 / currentUser.calorieGoal)
+            ? (totals[Nutrient::Calories] * 100 / currentUser.calorieGoal)
             : 0;
         
-        double proteinGoal = (currentUser.calorieGoal * currentUser.macroRatio.protein) / 4.0;
-        double carbsGoal   = (currentUser.calorieGoal * currentUser.macroRatio.carbs)   / 4.0;
-        double fatsGoal    = (currentUser.calorieGoal * currentUser.macroRatio.fats)    / 9.0;
+        Nutrients goals = MenuManager::dailyGoals(currentUser);
+        double proteinGoal = goals[Nutrient::Protein];
+        double carbsGoal   = goals[Nutrient::Carbs];
+        double fatsGoal    = goals[Nutrient::Fats];
         
-        int proteinPercent = (proteinGoal > 0) ? (totals.protein * 100 / proteinGoal) : 0;
-        int carbsPercent   = (carbsGoal   > 0) ? (totals.carbs   * 100 / carbsGoal)   : 0;
-        int fatsPercent    = (fatsGoal    > 0) ? (totals.fats    * 100 / fatsGoal)    : 0;
+        int proteinPercent = (proteinGoal > 0) ? (totals[Nutrient::Protein] * 100 / proteinGoal) : 0;
+        int carbsPercent   = (carbsGoal   > 0) ? (totals[Nutrient::Carbs]   * 100 / carbsGoal)   : 0;
+        int fatsPercent    = (fatsGoal    > 0) ? (totals[Nutrient::Fats]    * 100 / fatsGoal)    : 0;
         
         string calColor  = (calPercent > 100) ? RED : GRAY;
         string calStatus = (calPercent > 100) ? "OVER" : to_string(calPercent) + "%";
         
-        string calVal = to_string((int)totals.calories) + " / "
+        string calVal = to_string((int)totals[Nutrient::Calories]) + " / "
                       + to_string((int)currentUser.calorieGoal);
         cout << "     " << left << setw(10) << "Calories:"
              << right << setw(15) << calVal << "  [" << calColor;
@@ -130,7 +132,7 @@ void UI::showMainMenu() {
         string protStatus = (proteinPercent > 100)
             ? "DONE"
             : to_string(proteinPercent) + "%";
-        string protVal = to_string((int)totals.protein) + " / "
+        string protVal = to_string((int)totals[Nutrient::Protein]) + " / "
                        + to_string((int)proteinGoal) + "g";
         cout << "     " << left << setw(10) << "Protein:"
              << right << setw(15) << protVal << "  [" << protColor;
@@ -143,7 +145,7 @@ void UI::showMainMenu() {
         string carbsStatus = (carbsPercent > 100)
             ? "OVER"
             : to_string(carbsPercent) + "%";
-        string carbsVal = to_string((int)totals.carbs) + " / "
+        string carbsVal = to_string((int)totals[Nutrient::Carbs]) + " / "
                         + to_string((int)carbsGoal) + "g";
         cout << "     " << left << setw(10) << "Carbs:"
              << right << setw(15) << carbsVal << "  [" << carbsColor;
@@ -156,7 +158,7 @@ void UI::showMainMenu() {
         string fatsStatus = (fatsPercent > 100)
             ? "OVER"
             : to_string(fatsPercent) + "%";
-        string fatsVal = to_string((int)totals.fats) + " / "
+        string fatsVal = to_string((int)totals[Nutrient::Fats]) + " / "
                        + to_string((int)fatsGoal) + "g";
         cout << "     " << left << setw(10) << "Fats:"
              << right << setw(15) << fatsVal << "  [" << fatsColor;
@@ -165,6 +167,14 @@ void UI::showMainMenu() {
         for (int i = fatsBars; i < 20; i++) cout << "░";
         cout << RESET << "] " << fatsColor << fatsStatus << RESET << "\n";
         
+        // Fiber, sugar, and sodium share one line without bars.
+        cout << "     ";
+        for (int i = Nutrient::Fiber; i < Nutrient::Count; i++) {
+            cout << NUTRIENT_INFO[i].name << ": " << (int)totals[i] << " / "
+                 << (int)goals[i] << NUTRIENT_INFO[i].unit << "   ";
+        }
+        cout << "\n";
+        
         cout << "\n";
         int avgPercent = calPercent;
         if (avgPercent == 0) {
@@ -192,8 +202,9 @@ void UI::showMainMenu() {
         cout << "     " << YELLOW << "[2]" << RESET << " View/Edit logged foods\n";
         cout << "     " << YELLOW << "[3]" << RESET << " View menus\n";
         cout << "     " << YELLOW << "[4]" << RESET << " Generate meal plan\n";
-        cout << "     " << YELLOW << "[5]" << RESET << " Edit profile\n";
-        cout << "     " << YELLOW << "[6]" << RESET << " Logout\n";
+        cout << "     " << YELLOW << "[5]" << RESET << " Plan the week\n";
+        cout << "     " << YELLOW << "[6]" << RESET << " Edit profile\n";
+        cout << "     " << YELLOW << "[7]" << RESET << " Logout\n";
         cout << "\n";
         UIUtils::printSeparator();
         cout << "\n";
@@ -216,9 +227,12 @@ void UI::showMainMenu() {
                 menuUI.showMealGenerator();
                 break;
             case 5:
-                profileUI.showProfileEditor();
+                menuUI.showWeekPlanner();
                 break;
             case 6:
+                profileUI.showProfileEditor();
+                break;
+            case 7:
                 UIUtils::clearScreen();
                 UIUtils::printHeader("LOGOUT");
                 cout << "\n\n";
@@ -232,7 +246,7 @@ void UI::showMainMenu() {
                 break;
             default:
                 cout << "\n\n";
-                cout << "     Invalid choice. Please enter a number between 1 and 6.\n";
+                cout << "     Invalid choice. Please enter a number between 1 and 7.\n";
                 UIUtils::waitForEnter();
         }
     }
@@ -29,7 +29,7 @@ private:
 
 public:
     // Constructs the UI and wires submodules to shared state.
-    UI();
+    explicit UI(const MenuManager::PlanOptions& planOptions = MenuManager::PlanOptions());
 
     // Starts the application loop for login, main menu, and exit.
     void run();
@@ -1,11 +1,10 @@
 #include "UIUtils.h"
+#include "MenuCache.h"
 #include <iostream>
 #include <limits>
 #include <cstdlib>
-#include <filesystem>
 
 using namespace std;
-namespace fs = std::filesystem;
 
 // Clears the terminal screen for Windows or POSIX systems.
 void UIUtils::clearScreen() {
@@ -38,9 +37,30 @@ void UIUtils::waitForEnter() {
     cin.get();
 }
 
-// Runs menu.py to fetch or update a menu for a date/meal combination.
+// Manifest over ../data/menus shared by every fetch in the process.
+static MenuCache& menuCache() {
+    static MenuCache cache;
+    return cache;
+}
+
+// Sets how long fetched menus stay fresh and how large the cache may grow.
+void UIUtils::configureMenuCache(int ttlHours, int maxMegabytes) {
+    menuCache().configure(static_cast<int64_t>(ttlHours) * 3600,
+                          static_cast<uintmax_t>(maxMegabytes) * 1024 * 1024);
+}
+
+// Runs menu.py to fetch a menu for a date/meal combination, unless the
+// cache holds a fresh copy; a stale copy is replaced with --refresh.
 bool UIUtils::fetchMenuFor(const string& date, const string& mealType) {
+    string name = mealType + "-" + date + ".json";
+    if (menuCache().fresh(name)) {
+        return true;
+    }
+
     string args = " " + date + " " + mealType;
+    if (menuCache().known(name)) {
+        args += " --refresh";
+    }
 
 #ifdef _WIN32
     string cmd = "python menu.py" + args;
@@ -50,22 +70,11 @@ bool UIUtils::fetchMenuFor(const string& date, const string& mealType) {
         " || python menu.py" + args + " > /dev/null 2>&1";
 #endif
 
+    // A failed refresh leaves any stale copy in place without recording
+    // it as fetched, so the next request tries again.
     int result = system(cmd.c_str());
-    (void)result;
-    return true;
-}
-
-// Deletes all files in the menus cache directory, if it exists.
-void UIUtils::cleanMenuCache() {
-    string path = "../data/menus/";
-    try {
-        if (fs::exists(path)) {
-            for (const auto& entry : fs::directory_iterator(path)) {
-                if (entry.is_regular_file()) {
-                    fs::remove(entry.path());
-                }
-            }
-        }
-    } catch (...) {
+    if (result != 0) {
+        return false;
     }
+    return menuCache().record(name);
 }
@@ -18,12 +18,13 @@ public:
     // Waits for the user to press ENTER before continuing.
     static void waitForEnter();
 
-    // Fetches a menu JSON for a date and meal type using menu.py.
+    // Fetches a menu JSON for a date and meal type using menu.py, unless
+    // the menu cache holds a fresh copy; false if menu.py failed.
     static bool fetchMenuFor(const std::string& date,
                              const std::string& mealType);
 
-    // Removes all cached menu files from the menus directory.
-    static void cleanMenuCache();
+    // Sets the menu cache's time-to-live and size limit.
+    static void configureMenuCache(int ttlHours, int maxMegabytes);
 };
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef USER_H
 #define USER_H
 
+#include "NutrientVector.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -19,12 +20,20 @@ struct User {
     std::string password;
     int calorieGoal;
     MacroRatio macroRatio;
+    // Daily targets for the nutrients beyond the macros.
+    double fiberGoal;
+    double sugarGoal;
+    double sodiumGoal;
+    // Diet and allergen filter applied to every menu, e.g. "vegan, no
+    // peanuts" (see DietIndex::parseFilter); empty means no filter.
+    std::string dietFilter;
     std::map<std::string,
              std::map<std::string,
                       std::map<std::string, double>>> loggedMeals;
 
-    // Initializes a user with a default calorie goal and macro split.
-    User() : calorieGoal(2000) {
+    // Initializes a user with a default calorie goal and macro split;
+    // fiber, sugar, and sodium default to the FDA daily values.
+    User() : calorieGoal(2000), fiberGoal(28), sugarGoal(50), sodiumGoal(2300) {
         macroRatio.protein = 0.3;
         macroRatio.carbs   = 0.5;
         macroRatio.fats    = 0.2;
@@ -35,12 +44,14 @@ struct User {
 struct FoodItem {
     std::string name;
     std::string station;
-    int calories;
-    double protein;
-    double carbs;
-    double fats;
+    // Amounts per serving, indexed by Nutrient::Index.
+    Nutrients nutrients = {};
     std::string servingAmount;
     std::string servingUnit;
+    // Cleaned ingredient text and diet icons (e.g. "VG", "GFI") from the
+    // menu; either may be empty.
+    std::string ingredients;
+    std::vector<std::string> icons;
 };
 
 // Represents all menu items available on a given date.
@@ -1,27 +1,238 @@
 #include "UI.h"
 #include "UIUtils.h"
+#include "Auth.h"
+#include "MenuCache.h"
 #include <iostream>
-#include <csignal>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
 #include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
 
 using namespace std;
 
-// Handles Ctrl+C by cleaning up cached menus before exiting.
-void signalHandler(int signum) {
-    (void)signum;
-    cout << "\nInterrupted. Cleaning up...\n";
-    UIUtils::cleanMenuCache();
-    exit(signum);
+// Prints the supported command-line flags.
+static void printUsage(const char* program) {
+    cout << "Usage: " << program << " [options]\n"
+         << "  --solver=python|portfolio|decomposed\n"
+         << "                             Meal-plan solver (default: python)\n"
+         << "  --deadline-ms=N            Latency budget per meal in milliseconds (default: "
+         << MenuManager::DEFAULT_MEAL_DEADLINE_MS << ")\n"
+         << "  --formulation=onehot|integer\n"
+         << "                             Exact model used by --solver=python (default: onehot)\n"
+         << "  --alternatives=N           Plans offered per meal by the native solvers, each\n"
+         << "                             differing in at least two items (default: 1)\n"
+         << "  --no-plan-cache            Always solve; do not read or write the plan cache\n"
+         << "  --ingest=python|native     Fetch menus with menu.py (default) or in-process\n"
+         << "  --nutrislice-url=URL       Base URL for --ingest=native, e.g. a local stand-in\n"
+         << "  --district=NAME            Nutrislice district for --ingest=native (default: "
+         << NutrisliceClient::Config().district << ")\n"
+         << "  --school=NAME              Nutrislice school for --ingest=native (default: "
+         << NutrisliceClient::Config().school << ")\n"
+         << "  --menu-ttl-hours=N         Refetch cached menus older than N hours (default: "
+         << MenuCache::DEFAULT_TTL_HOURS << ")\n"
+         << "  --menu-cache-mb=N          Evict least recently used menus past N MB (default: "
+         << MenuCache::DEFAULT_MAX_MB << ")\n"
+         << "  --batch-plan[=YYYY-MM-DD]  Plan every user's meals for a date (default: tomorrow),\n"
+         << "                             print throughput and demand, and exit\n"
+         << "  --batch-threads=N          Worker threads for --batch-plan (default: all cores)\n"
+         << "  --batch-out=FILE           Write --batch-plan demand as meal/item/servings TSV\n";
+}
+
+// Menu cache limits from --menu-ttl-hours and --menu-cache-mb.
+struct MenuCacheArgs {
+    int ttlHours = MenuCache::DEFAULT_TTL_HOURS;
+    int maxMegabytes = MenuCache::DEFAULT_MAX_MB;
+};
+
+// Settings for a --batch-plan run; enabled is false for the interactive UI.
+struct BatchArgs {
+    bool enabled = false;
+    string date;
+    unsigned threads = 0;
+    string outPath;
+};
+
+// Returns tomorrow's date as "YYYY-MM-DD".
+static string tomorrow() {
+    time_t now = time(nullptr) + 24 * 60 * 60;
+    tm* ltm = localtime(&now);
+    char dateBuf[11];
+    strftime(dateBuf, sizeof(dateBuf), "%Y-%m-%d", ltm);
+    return dateBuf;
+}
+
+// Parses command-line flags into plan options; returns false on bad input.
+static bool parseArgs(int argc, char* argv[], MenuManager::PlanOptions& options,
+                      MenuCacheArgs& menuCache, BatchArgs& batch) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--solver=python") {
+            options.solverMode = MenuManager::SolverMode::Python;
+        } else if (arg == "--solver=portfolio") {
+            options.solverMode = MenuManager::SolverMode::Portfolio;
+        } else if (arg == "--solver=decomposed") {
+            options.solverMode = MenuManager::SolverMode::Decomposed;
+        } else if (arg == "--formulation=onehot" || arg == "--formulation=integer") {
+            options.pythonFormulation = arg.substr(14);
+        } else if (arg.rfind("--alternatives=", 0) == 0) {
+            try {
+                options.alternatives = stoi(arg.substr(15));
+            } catch (...) {
+                return false;
+            }
+            if (options.alternatives < 1) {
+                return false;
+            }
+            options.minItemDifference = options.alternatives > 1 ? 2 : 0;
+        } else if (arg == "--no-plan-cache") {
+            options.planCachePath.clear();
+        } else if (arg.rfind("--deadline-ms=", 0) == 0) {
+            try {
+                options.deadlineMs = stoi(arg.substr(14));
+            } catch (...) {
+                return false;
+            }
+            if (options.deadlineMs <= 0) {
+                return false;
+            }
+        } else if (arg == "--ingest=python" || arg == "--ingest=native") {
+            options.nativeIngestion = arg == "--ingest=native";
+        } else if (arg.rfind("--nutrislice-url=", 0) == 0) {
+            options.nutrislice.baseUrl = arg.substr(17);
+        } else if (arg.rfind("--district=", 0) == 0) {
+            options.nutrislice.district = arg.substr(11);
+        } else if (arg.rfind("--school=", 0) == 0) {
+            options.nutrislice.school = arg.substr(9);
+        } else if (arg.rfind("--menu-ttl-hours=", 0) == 0
+                   || arg.rfind("--menu-cache-mb=", 0) == 0) {
+            bool ttl = arg[7] == 't';
+            int value = 0;
+            try {
+                value = stoi(arg.substr(ttl ? 17 : 16));
+            } catch (...) {
+                return false;
+            }
+            if (value < 0) {
+                return false;
+            }
+            (ttl ? menuCache.ttlHours : menuCache.maxMegabytes) = value;
+        } else if (arg == "--batch-plan") {
+            batch.enabled = true;
+        } else if (arg.rfind("--batch-plan=", 0) == 0) {
+            batch.enabled = true;
+            batch.date = arg.substr(13);
+            if (batch.date.size() != 10) {
+                return false;
+            }
+        } else if (arg.rfind("--batch-threads=", 0) == 0) {
+            try {
+                batch.threads = static_cast<unsigned>(stoul(arg.substr(16)));
+            } catch (...) {
+                return false;
+            }
+        } else if (arg.rfind("--batch-out=", 0) == 0) {
+            batch.outPath = arg.substr(12);
+        } else {
+            return false;
+        }
+    }
+    if (batch.enabled && batch.date.empty()) {
+        batch.date = tomorrow();
+    }
+    return true;
+}
+
+// Plans all registered users for one date and reports throughput and the
+// most demanded items per meal.
+static int runBatch(const MenuManager::PlanOptions& planOptions, const BatchArgs& args) {
+    Auth auth;
+    const vector<User>& users = auth.getUsers();
+    if (users.empty()) {
+        cerr << "Error: no registered users to plan for" << endl;
+        return 1;
+    }
+
+    MenuManager menuManager;
+    menuManager.setPlanOptions(planOptions);
+    MenuManager::BatchPlanResult batch =
+        menuManager.generateBatchPlans(users, args.date, args.threads);
+
+    cout << "Batch plan for " << batch.dateStr << ": " << users.size() << " users, "
+         << batch.mealPlans << " meal plans (" << batch.cachedPlans << " from cache) in "
+         << fixed << setprecision(2) << batch.solveSeconds << " s, "
+         << setprecision(1) << batch.plansPerSecond() << " plans/s\n";
+
+    // Where solver time went, summed over every fresh solve.
+    double buildSeconds = 0.0, searchSeconds = 0.0;
+    long long nodes = 0;
+    int optimal = 0, presolvedOptimal = 0, deadline = 0, failed = 0;
+    for (const auto& plan : batch.plans) {
+        for (const auto& meal : plan.second.solveInfo) {
+            const auto& info = meal.second;
+            buildSeconds += info.buildSeconds;
+            searchSeconds += info.solveSeconds;
+            nodes += info.nodes;
+            optimal += info.status == MenuManager::SolveStatus::Optimal;
+            presolvedOptimal += info.status == MenuManager::SolveStatus::PresolvedOptimal;
+            deadline += info.status == MenuManager::SolveStatus::Deadline;
+            failed += info.status == MenuManager::SolveStatus::Failed;
+        }
+    }
+    cout << "Solver time: build " << setprecision(3) << buildSeconds << " s, search "
+         << searchSeconds << " s, " << nodes << " nodes; " << optimal << " optimal, "
+         << presolvedOptimal << " optimal over presolved items, "
+         << deadline << " hit the deadline, " << failed << " failed\n";
+
+    for (const auto& meal : batch.demand) {
+        vector<pair<string, double>> items(meal.second.begin(), meal.second.end());
+        sort(items.begin(), items.end(), [](const pair<string, double>& a,
+                                            const pair<string, double>& b) {
+            return a.second > b.second;
+        });
+        cout << "\n" << meal.first << " demand (servings):\n";
+        for (size_t i = 0; i < items.size() && i < 10; i++) {
+            cout << "  " << setw(6) << items[i].second << "  " << items[i].first << "\n";
+        }
+    }
+
+    if (!args.outPath.empty()) {
+        ofstream out(args.outPath);
+        if (!out.is_open()) {
+            cerr << "Error: cannot write " << args.outPath << endl;
+            return 1;
+        }
+        out << "meal\titem\tservings\n";
+        for (const auto& meal : batch.demand) {
+            for (const auto& item : meal.second) {
+                out << meal.first << '\t' << item.first << '\t' << item.second << "\n";
+            }
+        }
+    }
+    return 0;
 }
 
 // Entry point for the Macro Meal Tracker application.
-int main() {
-    signal(SIGINT, signalHandler);
+int main(int argc, char* argv[]) {
+    MenuManager::PlanOptions planOptions;
+    MenuCacheArgs menuCacheArgs;
+    BatchArgs batchArgs;
+    if (!parseArgs(argc, argv, planOptions, menuCacheArgs, batchArgs)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Downloaded menus persist across sessions under the cache's limits.
+    UIUtils::configureMenuCache(menuCacheArgs.ttlHours, menuCacheArgs.maxMegabytes);
 
     try {
-        UI ui;
+        if (batchArgs.enabled) {
+            return runBatch(planOptions, batchArgs);
+        }
+        UI ui(planOptions);
         ui.run();
-        UIUtils::cleanMenuCache();
     } catch (const exception& e) {
         cerr << "Error: " << e.what() << endl;
         return 1;
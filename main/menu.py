@@ -1,7 +1,6 @@
 #!/usr/bin/env python3
 
-import requests
-from datetime import datetime
+from datetime import datetime, timedelta
 import os
 import json
 import re
@@ -15,36 +14,46 @@ MEAL_TYPES = {"breakfast", "lunch", "dinner"}
 # Folder where extracted and simplified menus are stored.
 DESTINATION_FOLDER = '../data/menus'
 
-# Station filters for building simplified menus used by the solver.
-EXCLUDED_STATIONS_CONFIG = {
-    "breakfast": {
-        "exact": [
-            "Omelet Station",
-            "Yogurt & Oatmeal Bar",
-            "Avocado Bar",
-            "Toasted",
-            "Nut Zone",
-            "Condiment",
-        ],
-        "contains": [],
-    },
-    "lunch_dinner": {
-        "exact": [
-            "Panini",
-            "Campus Deli",
-            "Salad Bar",
-            "Condiment",
-            "Toasted",
-            "Nut Zone",
-            "Avocado Bar",
-        ],
-        "contains": ["Daily Bite"],
-    },
-}
+# Station filters for building simplified menus used by the solver, shared
+# with MenuManager's native simplification.
+STATION_RULES_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "station_rules.conf")
+
+
+def load_station_rules(path: str = STATION_RULES_PATH):
+    """Read station_rules.conf into {meal type: {"exact": [...], "contains": [...]}}."""
+    rules = {}
+    meals = []
+    try:
+        with open(path, "r") as f:
+            lines = f.readlines()
+    except OSError:
+        return rules
+
+    for line in lines:
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        if line.startswith("[") and line.endswith("]"):
+            meals = line[1:-1].split()
+            for meal in meals:
+                rules.setdefault(meal, {"exact": [], "contains": []})
+            continue
+        kind, _, value = line.partition(" ")
+        if kind in ("exact", "contains") and value.strip():
+            for meal in meals:
+                rules[meal][kind].append(value.strip())
+    return rules
+
+
+EXCLUDED_STATIONS_CONFIG = load_station_rules()
 
 
 def fetch_menu(dining_hall: str, meal_type: str, date: datetime):
     """Fetch the Nutrislice weekly menu JSON for one dining hall, meal, and date."""
+    # Imported here so tools that only use the helpers below (such as
+    # nutrislice_standin.py) run without requests installed.
+    import requests
+
     year = date.year
     month = date.strftime('%m')
     day = date.strftime('%d')
@@ -63,6 +72,42 @@ def fetch_menu(dining_hall: str, meal_type: str, date: datetime):
         return None, year, month, day
 
 
+def week_start(date: datetime) -> datetime:
+    """Return the Sunday that starts the Nutrislice week containing date."""
+    return date - timedelta(days=(date.weekday() + 1) % 7)
+
+
+def week_cache_path(meal_type: str, date: datetime, output_dir: str = DESTINATION_FOLDER) -> str:
+    """Return where the raw weekly response covering date is cached."""
+    return os.path.join(output_dir, f"week-{meal_type}-{week_start(date).strftime('%Y-%m-%d')}.json")
+
+
+def load_week(dining_hall: str, meal_type: str, date: datetime,
+              output_dir: str = DESTINATION_FOLDER, refresh: bool = False):
+    """
+    Return the weekly menu covering date, from the raw response cached on disk
+    if it holds that date (and refresh is off), otherwise from Nutrislice
+    (caching the response).
+    """
+    cache_path = week_cache_path(meal_type, date, output_dir)
+    date_str = date.strftime("%Y-%m-%d")
+    if not refresh and os.path.exists(cache_path):
+        try:
+            with open(cache_path, "r") as f:
+                menu_data = json.load(f)
+            if any(d.get("date") == date_str for d in menu_data.get("days", [])):
+                return menu_data
+        except (OSError, ValueError):
+            pass
+
+    menu_data, _, _, _ = fetch_menu(dining_hall, meal_type, date)
+    if menu_data:
+        os.makedirs(output_dir, exist_ok=True)
+        with open(cache_path, "w") as f:
+            json.dump(menu_data, f)
+    return menu_data
+
+
 def clean_ingredients(text):
     """Normalize an ingredient string by removing brackets, punctuation, and extra spaces."""
     if not isinstance(text, str):
@@ -107,7 +152,8 @@ def extract_day_menu(day_obj):
             if "synced_name" in icon
         ]
 
-        # Rounded nutrition info (we only keep the main macros and calories).
+        # Rounded nutrition info: calories and macros, then the optional
+        # nutrients the planner can also target.
         full_nutrition = food.get("rounded_nutrition_info", {}) or {}
 
         nutrition = {
@@ -115,6 +161,9 @@ def extract_day_menu(day_obj):
             "g_fat": full_nutrition.get("g_fat"),
             "g_carbs": full_nutrition.get("g_carbs"),
             "g_protein": full_nutrition.get("g_protein"),
+            "g_fiber": full_nutrition.get("g_fiber"),
+            "g_sugar": full_nutrition.get("g_sugar"),
+            "mg_sodium": full_nutrition.get("mg_sodium"),
         }
 
         extracted_entry = {
@@ -137,8 +186,19 @@ def extract_day_menu(day_obj):
     return sections
 
 
-def generate_extracted_file(date_str: str, meal_type: str, output_dir: str = DESTINATION_FOLDER):
-    """Fetch and save one day's menu as a structured JSON file."""
+def extracted_path(meal_type: str, date_str: str, output_dir: str = DESTINATION_FOLDER) -> str:
+    """Return the path of the extracted menu for one meal and date."""
+    return os.path.join(output_dir, f"{meal_type}-{date_str}.json")
+
+
+def generate_extracted_file(date_str: str, meal_type: str, output_dir: str = DESTINATION_FOLDER,
+                            refresh: bool = False):
+    """
+    Save one day's menu as a structured JSON file. Nutrislice answers with a
+    whole week, so every day of that week is extracted in the same pass and
+    later dates are served from disk without another request. With refresh,
+    the week is downloaded again and every day of it is rewritten.
+    """
     if meal_type not in MEAL_TYPES:
         raise ValueError(f"meal must be one of {MEAL_TYPES}, got {meal_type!r}")
 
@@ -147,70 +207,47 @@ def generate_extracted_file(date_str: str, meal_type: str, output_dir: str = DES
     except ValueError:
         raise ValueError("date must be in format YYYY-MM-DD")
 
-    # Pull the weekly menu and select the specific day.
-    menu_data, year, month, day = fetch_menu(DINING_HALL, meal_type, date)
+    # Normalize the date so file names match the C++ side.
+    date_str = date.strftime("%Y-%m-%d")
+    out_path = extracted_path(meal_type, date_str, output_dir)
+    if not refresh and os.path.exists(out_path):
+        print(f"Using extracted menu in {out_path}")
+        return
+
+    # Pull the weekly menu, from the raw cache when it covers this date.
+    menu_data = load_week(DINING_HALL, meal_type, date, output_dir, refresh)
     if not menu_data:
         raise RuntimeError("Failed to fetch menu data from Nutrislice")
 
-    target_date = date_str
-    target_day_obj = None
-    for day_obj in menu_data.get("days", []):
-        if day_obj.get("date") == target_date:
-            target_day_obj = day_obj
-            break
-
-    if target_day_obj is None:
-        raise RuntimeError(f"No menu found for {target_date} ({meal_type})")
-
-    # Convert Nutrislice day's structure into our flattened station→list format.
-    extracted = extract_day_menu(target_day_obj)
+    days = [d for d in menu_data.get("days", []) if d.get("date")]
+    if not any(d["date"] == date_str for d in days):
+        raise RuntimeError(f"No menu found for {date_str} ({meal_type})")
 
     os.makedirs(output_dir, exist_ok=True)
 
-    filename = f"{meal_type}-{date.year}-{date.strftime('%m')}-{date.strftime('%d')}.json"
-    out_path = os.path.join(output_dir, filename)
+    # Convert each day's structure into our flattened station→list format
+    # and save it, leaving days already on disk as they are.
+    for day_obj in days:
+        day_path = extracted_path(meal_type, day_obj["date"], output_dir)
+        if not refresh and os.path.exists(day_path):
+            continue
+        with open(day_path, "w") as f:
+            json.dump(extract_day_menu(day_obj), f, indent=2)
 
-    # Save full extracted menu for that meal/date.
-    with open(out_path, "w") as f:
-        json.dump(extracted, f, indent=2)
+    print(f"Saved extracted menus for the week of {days[0]['date']}, including {out_path}")
 
-    print(f"Saved extracted menu to {out_path}")
 
+def menu_category(menu_filename: str):
+    """Return the meal type whose station rules apply to a menu file name, or None."""
+    meal = os.path.basename(menu_filename).split("-", 1)[0]
+    return meal if meal in MEAL_TYPES else None
 
-def simplify_menu_file(
-    menu_filename: str,
-    destination_folder: str = DESTINATION_FOLDER,
-) -> str:
-    """
-    Simplify a saved menu JSON by filtering stations and deduplicating items by name.
 
-    Returns the path to the new simplified menu file.
+def simplify_menu(data, category):
+    """
+    Filter a menu's stations with the rules for category and deduplicate items by
+    name. Returns the simplified structure; data is not modified.
     """
-    # If just a filename is given, treat it as relative to the destination folder.
-    if not os.path.isabs(menu_filename) and os.sep not in menu_filename:
-        src_path = os.path.join(destination_folder, menu_filename)
-    else:
-        src_path = menu_filename
-        destination_folder = os.path.dirname(src_path)
-
-    src_path = os.path.abspath(src_path)
-    destination_folder = os.path.abspath(destination_folder)
-
-    if not os.path.exists(src_path):
-        raise FileNotFoundError(src_path)
-
-    with open(src_path, "r") as f:
-        data = json.load(f)
-
-    # Determine which filter rules to apply based on the meal embedded in filename.
-    base = os.path.basename(src_path)
-    if base.startswith("breakfast-"):
-        category = "breakfast"
-    elif base.startswith("lunch-") or base.startswith("dinner-"):
-        category = "lunch_dinner"
-    else:
-        category = None
-
     # Filter out unwanted stations for the solver (e.g., salad bar, condiments).
     if isinstance(data, dict) and category is not None:
         rules = EXCLUDED_STATIONS_CONFIG.get(category, {})
@@ -235,6 +272,8 @@ def simplify_menu_file(
                 continue
 
             simplified[station] = items
+    elif isinstance(data, dict):
+        simplified = dict(data)
     else:
         # If structure is unexpected, fall back to passing data unchanged.
         simplified = data
@@ -264,8 +303,36 @@ def simplify_menu_file(
 
             simplified[station] = deduped
 
-    out_name = f"simplified-{base}"
-    out_path = os.path.join(destination_folder, out_name)
+    return simplified
+
+
+def resolve_menu_path(menu_filename: str, destination_folder: str = DESTINATION_FOLDER) -> str:
+    """Return the absolute path of a saved menu; bare names live in destination_folder."""
+    if not os.path.isabs(menu_filename) and os.sep not in menu_filename:
+        return os.path.abspath(os.path.join(destination_folder, menu_filename))
+    return os.path.abspath(menu_filename)
+
+
+def simplify_menu_file(
+    menu_filename: str,
+    destination_folder: str = DESTINATION_FOLDER,
+) -> str:
+    """
+    Simplify a saved menu JSON by filtering stations and deduplicating items by name.
+
+    Returns the path to the new simplified menu file.
+    """
+    src_path = resolve_menu_path(menu_filename, destination_folder)
+    if not os.path.exists(src_path):
+        raise FileNotFoundError(src_path)
+
+    with open(src_path, "r") as f:
+        data = json.load(f)
+
+    simplified = simplify_menu(data, menu_category(src_path))
+
+    out_name = f"simplified-{os.path.basename(src_path)}"
+    out_path = os.path.join(os.path.dirname(src_path), out_name)
 
     # Write the simplified structure to disk for the solver.
     with open(out_path, "w") as f:
@@ -276,23 +343,25 @@ def simplify_menu_file(
 
 if __name__ == "__main__":
     # CLI entry point: generate one extracted menu JSON for a given date/meal.
-    if len(sys.argv) == 3:
+    args = [a for a in sys.argv[1:] if a != "--refresh"]
+    refresh_arg = len(args) < len(sys.argv) - 1
+    if len(args) == 2:
         # Form: python menu.py YYYY-MM-DD breakfast
-        date_arg = sys.argv[1]
-        meal_arg = sys.argv[2].lower()
-    elif len(sys.argv) == 2:
+        date_arg = args[0]
+        meal_arg = args[1].lower()
+    elif len(args) == 1:
         # Form: python menu.py breakfast   (defaults to today's date)
-        meal_arg = sys.argv[1].lower()
+        meal_arg = args[0].lower()
         today = datetime.now().date()
         date_arg = today.strftime("%Y-%m-%d")
     else:
         print("Usage:")
-        print("  python menu.py YYYY-MM-DD [breakfast|lunch|dinner]")
-        print("  python menu.py [breakfast|lunch|dinner]   (uses today's date)")
+        print("  python menu.py YYYY-MM-DD [breakfast|lunch|dinner] [--refresh]")
+        print("  python menu.py [breakfast|lunch|dinner] [--refresh]   (uses today's date)")
         sys.exit(1)
 
     try:
-        generate_extracted_file(date_arg, meal_arg)
+        generate_extracted_file(date_arg, meal_arg, refresh=refresh_arg)
     except Exception as e:
         print(f"Error: {e}")
         sys.exit(1)
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the Nutrislice weeks API, for testing menu ingestion
+offline. It answers
+
+    GET /menu/api/weeks/school/<school>/menu-type/<meal>/<YYYY>/<MM>/<DD>/
+
+with the recorded response in <fixtures>/week-<meal>-<sunday>.json, the raw
+weekly files menu.py keeps in data/menus, and 404 when there is none. With
+--record, misses are fetched from the live district API and saved as new
+fixtures.
+
+Usage:
+    python nutrislice_standin.py [--port 8765] [--fixtures ../data/menus]
+                                 [--delay-ms 0] [--record] [--district richmond]
+
+Point the app at it with --ingest=native --nutrislice-url=http://127.0.0.1:8765.
+"""
+import argparse
+import os
+import re
+import time
+import urllib.request
+from datetime import datetime
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+from menu import DESTINATION_FOLDER, DISTRICT, week_cache_path
+
+WEEK_PATH = re.compile(
+    r"^/menu/api/weeks/school/[^/]+/menu-type/(?P<meal>[^/]+)/"
+    r"(?P<year>\d{4})/(?P<month>\d{1,2})/(?P<day>\d{1,2})/?$"
+)
+
+
+def make_handler(fixtures, delay_ms, record, district):
+    class StandInHandler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def do_GET(self):
+            if delay_ms > 0:
+                time.sleep(delay_ms / 1000.0)
+
+            path = self.path.split("?", 1)[0]
+            match = WEEK_PATH.match(path)
+            if not match:
+                return self.reply(404, b'{"error": "unknown endpoint"}')
+
+            try:
+                date = datetime(int(match["year"]), int(match["month"]), int(match["day"]))
+            except ValueError:
+                return self.reply(400, b'{"error": "bad date"}')
+            fixture = week_cache_path(match["meal"], date, fixtures)
+
+            if not os.path.exists(fixture) and record:
+                url = f"https://{district}.api.nutrislice.com{self.path}"
+                try:
+                    with urllib.request.urlopen(url, timeout=30) as upstream:
+                        body = upstream.read()
+                except OSError as e:
+                    return self.reply(502, f'{{"error": "{e}"}}'.encode("utf-8"))
+                os.makedirs(fixtures, exist_ok=True)
+                with open(fixture, "wb") as f:
+                    f.write(body)
+
+            if not os.path.exists(fixture):
+                return self.reply(404, b'{"error": "no recorded week"}')
+            with open(fixture, "rb") as f:
+                self.reply(200, f.read())
+
+        def reply(self, status, body):
+            self.send_response(status)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):
+            pass
+
+    return StandInHandler
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve recorded Nutrislice weekly menus.")
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--fixtures", default=DESTINATION_FOLDER,
+                        help="directory of week-<meal>-<sunday>.json responses")
+    parser.add_argument("--delay-ms", type=float, default=0.0,
+                        help="added latency per request, to mimic the live API")
+    parser.add_argument("--record", action="store_true",
+                        help="fetch and save weeks that have no fixture yet")
+    parser.add_argument("--district", default=DISTRICT)
+    args = parser.parse_args()
+
+    handler = make_handler(args.fixtures, args.delay_ms, args.record, args.district)
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), handler)
+    print(f"Serving {os.path.abspath(args.fixtures)} on http://127.0.0.1:{args.port}", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
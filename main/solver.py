@@ -1,99 +1,526 @@
 import numpy as np
 import cvxpy as cp
 import pandas as pd
+import hashlib
 import json
+import multiprocessing
 import sys
+import time
+from collections import OrderedDict
 
+# Default wall-clock budget for one solve when run from the command line.
+DEFAULT_DEADLINE_MS = 200
 
-def solve_meal_plan(menu, target, verbose: bool = True):
+# Nutrients in planning order, matching Nutrient::Index in NutrientVector.h.
+# A solve matches the first len(target) of them. The first four are required
+# for every item; the others count as zero when a menu lacks them.
+NUTRIENT_KEYS = ["calories", "g_protein", "g_carbs", "g_fat", "g_fiber", "g_sugar", "mg_sodium"]
+NUTRIENT_LABELS = ["Calories", "Protein (g)", "Carbs (g)", "Fat (g)", "Fiber (g)", "Sugar (g)", "Sodium (mg)"]
+REQUIRED_NUTRIENTS = 4
+
+# Planning-unit scale per nutrient, as in NUTRIENT_INFO: keeps sodium (mg)
+# from dominating the squared error.
+PLAN_SCALE = {"mg_sodium": 0.1}
+
+# Exact model formulations: "onehot" picks each item's serving with one boolean
+# per serving size; "integer" uses one bounded integer level per item plus one
+# indicator boolean for the item cap.
+FORMULATIONS = ("onehot", "integer")
+DEFAULT_FORMULATION = "onehot"
+
+# Compiled exact models kept per menu, most recently used last.
+MODEL_CACHE_SIZE = 16
+_exact_models = OrderedDict()
+
+# Exact solves run in a child process so they can be abandoned at the
+# deadline. A forked child inherits the compiled models, so fork wherever the
+# platform offers it, whatever the default start method (spawn on macOS,
+# forkserver from Python 3.14); elsewhere (Windows) each child builds its own.
+FORK_AVAILABLE = "fork" in multiprocessing.get_all_start_methods()
+_exact_context = multiprocessing.get_context("fork" if FORK_AVAILABLE else None)
+
+
+def _relaxation_bound(A, g, upper, iterations: int = 500):
     """
-    Solve a simple meal-planning optimization problem for the given menu and macro targets.
+    Solve the box relaxation 0 <= x <= upper of min ||Ax - g||^2 with accelerated
+    projected gradient. Returns the relaxed x and a lower bound that is valid for
+    any iterate, using the residual z as a Lagrange multiplier:
+        -||z||^2 - 2 z.g + 2 * upper * sum(min(0, A^T z)).
+    """
+    n = A.shape[1]
+    x = np.zeros(n)
+    if n == 0:
+        return x, float(g @ g)
+
+    # Lipschitz constant of the gradient, padded so steps never overshoot.
+    lipschitz = max(2.0 * np.linalg.eigvalsh(A @ A.T).max() * 1.05, 1e-9)
+
+    y = x.copy()
+    t = 1.0
+    for _ in range(iterations):
+        grad = 2.0 * A.T @ (A @ y - g)
+        x_next = np.clip(y - grad / lipschitz, 0.0, upper)
+        t_next = (1.0 + np.sqrt(1.0 + 4.0 * t * t)) / 2.0
+        y = x_next + ((t - 1.0) / t_next) * (x_next - x)
+        x, t = x_next, t_next
+
+    z = A @ x - g
+    bound = -(z @ z) - 2.0 * (z @ g) + 2.0 * upper * np.minimum(0.0, A.T @ z).sum()
+    return x, max(float(bound), 0.0)
+
+
+def _polish(A, g, levels, step, max_level, max_items):
+    """
+    Apply the best improving single-item serving change until none is left,
+    then try swapping one chosen item for an unchosen one; repeat until
+    neither move improves the plan.
+    """
+    levels = levels.copy()
+    if A.shape[1] == 0:
+        return levels
+    norms = (A * A).sum(axis=0)
+    candidate_levels = np.arange(max_level + 1)
+
+    while True:
+        r = A @ (step * levels) - g
+        dots = A.T @ r
+        delta = step * (candidate_levels[None, :] - levels[:, None])
+        change = 2.0 * delta * dots[:, None] + delta * delta * norms[:, None]
+
+        # Respect the item cap: unchosen items may not be added when full.
+        if np.count_nonzero(levels) >= max_items:
+            change[levels == 0, 1:] = np.inf
+
+        j, k = np.unravel_index(np.argmin(change), change.shape)
+        if change[j, k] < -1e-9:
+            levels[j] = k
+            continue
 
-    menu   – list of items with 'nutrition' and 'serving_size' fields
-    target – dict with keys: calories, g_protein, g_carbs, g_fat
+        # Swap: drop chosen item j, then add unchosen item k at level q.
+        base = r @ r
+        best_swap, best_value = None, base - 1e-9
+        unchosen = levels == 0
+        for j in np.flatnonzero(levels):
+            r_out = r - step * levels[j] * A[:, j]
+            add = step * candidate_levels[None, 1:]
+            values = (r_out @ r_out) + 2.0 * add * (A.T @ r_out)[:, None] + add * add * norms[:, None]
+            values[~unchosen] = np.inf
+            k, q = np.unravel_index(np.argmin(values), values.shape)
+            if values[k, q] < best_value:
+                best_swap, best_value = (j, k, q + 1), values[k, q]
+
+        if best_swap is None:
+            return levels
+        j, k, q = best_swap
+        levels[j] = 0
+        levels[k] = q
+
+
+def _heuristic_plan(A, g, serving_sizes, max_items, restarts: int = 8):
     """
-    # Desired macro vector (goal).
-    g = np.array([
-        target["calories"],
-        target["g_protein"],
-        target["g_carbs"],
-        target["g_fat"]
-    ])
+    Fast incumbent for the anytime solve: round the box relaxation several
+    ways (to nearest, up, and randomly), keep the max_items largest servings
+    of each rounding, polish them, and return the best. Also returns the
+    relaxation's lower bound on the optimal objective.
+    """
+    step = serving_sizes[0]
+    max_level = len(serving_sizes)
+    x, bound = _relaxation_bound(A, g, serving_sizes[-1])
+    scaled = x / step
+
+    rng = np.random.default_rng(0)
+    roundings = [np.rint(scaled), np.ceil(scaled)]
+    for _ in range(restarts):
+        roundings.append(np.floor(scaled) + (rng.random(len(x)) < scaled - np.floor(scaled)))
+
+    best_levels, best_objective = None, np.inf
+    for rounded in roundings:
+        levels = np.clip(rounded, 0, max_level).astype(int)
+        if np.count_nonzero(levels) > max_items:
+            levels[np.argsort(-x)[max_items:]] = 0
+
+        levels = _polish(A, g, levels, step, max_level, max_items)
+        r = A @ (step * levels) - g
+        if r @ r < best_objective:
+            best_levels, best_objective = levels, r @ r
+
+    return step * best_levels, bound
+
+
+def presolve_menu(A, g, serving_sizes):
+    """
+    Shrink the candidate set before the model is built.
+
+    1. Drop items whose smallest serving already exceeds the calorie budget.
+    2. Merge items with identical macro vectors into the first occurrence.
+    3. Drop items with no macros, and same-calorie items that another item
+       beats in every macro with respect to the goal's per-calorie profile.
+    4. Among items that are scaled copies of each other, keep the one whose
+       serving sizes land closest to the goal's projection onto that ray.
+
+    Only the dropped zero rows are always safe; every other rule is a heuristic
+    (an over-budget item or a second copy of an item can still lower the error),
+    so the optimum over the kept items need not be the optimum for the menu.
+    Returns the kept column indices and a dict of reduction counts.
+    """
+    n = A.shape[1]
+    step = serving_sizes[0]
+    stats = {"items_before": n, "over_budget": 0, "merged": 0, "dominated": 0}
+
+    alive = []
+    for j in range(n):
+        if step * A[0, j] > g[0]:
+            stats["over_budget"] += 1
+        else:
+            alive.append(j)
+
+    unique, seen = [], set()
+    for j in alive:
+        key = tuple(A[:, j])
+        if key in seen:
+            stats["merged"] += 1
+        else:
+            seen.add(key)
+            unique.append(j)
+
+    removed = set()
+    for j in unique:
+        a_j = A[:, j]
+        if not a_j.any():
+            removed.add(j)
+            continue
+        if g[0] <= 0:
+            continue
+
+        profile = a_j[0] * g[1:] / g[0]
+        d_j = np.abs(a_j[1:] - profile)
+        for k in unique:
+            if k == j or k in removed or abs(A[0, k] - a_j[0]) > 0.5:
+                continue
+            d_k = np.abs(A[1:, k] - profile)
+            if np.all(d_k <= d_j) and np.any(d_k < d_j):
+                removed.add(j)
+                break
+
+    for p, base in enumerate(unique):
+        if base in removed:
+            continue
+        a = A[:, base]
+        aa = a @ a
+        along = (g @ a) / aa
+
+        group, best_item, best_distance = [], None, np.inf
+        for j in unique[p:]:
+            if j in removed:
+                continue
+            b = A[:, j]
+            ab, bb = a @ b, b @ b
+            # Cauchy-Schwarz is tight only for parallel vectors.
+            if bb <= 0 or ab <= 0 or ab * ab < aa * bb * (1 - 1e-12):
+                continue
+            group.append(j)
+            distance = np.min(np.abs(along - (ab / aa) * serving_sizes))
+            if distance < best_distance:
+                best_item, best_distance = j, distance
+
+        removed.update(j for j in group if j != best_item)
+
+    keep = [j for j in unique if j not in removed]
+    stats["dominated"] = len(unique) - len(keep)
+    stats["items_after"] = len(keep)
+    return keep, stats
+
+
+def build_exact_model(A, serving_sizes, max_items, formulation=DEFAULT_FORMULATION):
+    """
+    Build the mixed-integer model. Every term is a single matrix expression, so
+    canonicalization cost does not grow with Python loops.
+
+    onehot  – one boolean matrix B (items × serving sizes), where B[i, k] = 1 if
+              item i is taken at serving_sizes[k], with at most one per row.
+    integer – one integer level z[i] in 0..len(serving_sizes) per item (servings
+              = serving_sizes[0] * z[i]) and one boolean y[i] that must be set for
+              z[i] > 0; the item cap counts y. Branching on one level per item
+              avoids the symmetric one-hot choices. It requires evenly spaced
+              serving sizes.
+
+    The goal and the mask of items presolve kept are cp.Parameters, and the problem
+    is DPP, so it can be re-solved for new goals without canonicalizing again.
+    Returns the problem, the servings expression x, and the goal and allowed-item
+    parameters.
+    """
+    n_items = A.shape[1]
+    n_sizes = len(serving_sizes)
+    goal = cp.Parameter(A.shape[0])
+    allowed = cp.Parameter(n_items, nonneg=True)
+
+    if formulation == "integer":
+        z = cp.Variable(n_items, integer=True)
+        y = cp.Variable(n_items, boolean=True)
+        x = serving_sizes[0] * z
+        constraints = [
+            z >= 0,
+            # A level above zero needs the item's indicator, and presolve-dropped
+            # items may not set it.
+            z <= n_sizes * y,
+            y <= allowed,
+            # Global bound on the number of chosen items.
+            cp.sum(y) <= max_items,
+        ]
+    else:
+        B = cp.Variable((n_items, n_sizes), boolean=True)
+        x = B @ serving_sizes
+        constraints = [
+            # At most one serving-size option per item (or none), and none for
+            # items presolve dropped.
+            cp.sum(B, axis=1) <= allowed,
+            # Global bound on the number of chosen items.
+            cp.sum(B) <= max_items,
+        ]
+
+    # Objective: minimize squared error between actual macros and target macros.
+    objective = cp.Minimize(cp.sum_squares(A @ x - goal))
+    return cp.Problem(objective, constraints), x, goal, allowed
+
+
+def branch_nodes(problem):
+    """
+    Return the number of branch-and-bound nodes ECOS_BB explored in the last solve,
+    or its interior-point iteration count if the node count is not reported.
+    """
+    stats = problem.solver_stats
+    extra = getattr(stats, "extra_stats", None)
+    info = extra.get("info", {}) if isinstance(extra, dict) else {}
+    if "mi_iter" in info:
+        return int(info["mi_iter"])
+    return stats.num_iters
+
+
+def exact_model(A, serving_sizes, max_items, formulation=DEFAULT_FORMULATION):
+    """
+    Return the cached (problem, x, goal, allowed) for this menu matrix, building
+    and compiling it on first use. A is the full menu before presolve, so one
+    entry serves every goal.
+    """
+    digest = hashlib.sha1(np.ascontiguousarray(A, dtype=float).tobytes())
+    digest.update(repr((A.shape, tuple(serving_sizes), max_items, formulation)).encode())
+    key = digest.hexdigest()
+
+    model = _exact_models.get(key)
+    if model is not None:
+        _exact_models.move_to_end(key)
+        return model
+
+    model = build_exact_model(A, serving_sizes, max_items, formulation)
+    problem, _, goal, allowed = model
+    # Compile now with placeholder values; later solves only set parameters.
+    goal.value = np.zeros(A.shape[0])
+    allowed.value = np.ones(A.shape[1])
+    problem.get_problem_data(cp.ECOS_BB)
+
+    _exact_models[key] = model
+    while len(_exact_models) > MODEL_CACHE_SIZE:
+        _exact_models.popitem(last=False)
+    return model
+
+
+def _solve_exact(A, g, keep, serving_sizes, max_items, formulation, conn):
+    """
+    Solve the cached ECOS_BB model for goal g over the kept items, sending
+    the full serving vector (None on failure) and the node count through
+    conn. Runs in a forked child where available (see _exact_context), which
+    inherits the parent's compiled model; otherwise it builds its own.
+    """
+    problem, x, goal, allowed = exact_model(A, serving_sizes, max_items, formulation)
+    mask = np.zeros(A.shape[1])
+    mask[keep] = 1.0
+    goal.value = g
+    allowed.value = mask
+
+    # Mixed-integer convex problem: use ECOS_BB which wraps ECOS + branch-and-bound.
+    problem.solve(solver=cp.ECOS_BB, verbose=False)
+
+    if problem.status in ("optimal", "optimal_inaccurate") and x.value is not None:
+        conn.send((np.asarray(x.value, dtype=float), branch_nodes(problem)))
+    else:
+        conn.send((None, branch_nodes(problem)))
+    conn.close()
+
+
+def solve_matrix(A, g, deadline_ms=None, formulation=DEFAULT_FORMULATION, start_time=None):
+    """
+    Plan servings for a nutrient matrix A (nutrients × items, planning units) and
+    goal g: presolve, a heuristic incumbent, then the exact model until the deadline.
+
+    Returns a dict with the servings per column of A, the status ("optimal",
+    "presolved" when optimal only over the items presolve kept, "heuristic", or
+    "deadline"), objective, lower bound, gap, presolve counts, and
+    telemetry: "build_ms" (presolve and model compilation), "solve_ms" (heuristic
+    and exact search), and "nodes" (ECOS_BB branch-and-bound nodes, 0 if the exact
+    solve did not finish).
+    """
+    # Time the caller spent assembling A counts as model build.
+    if start_time is None:
+        start_time = time.monotonic()
+    build_seconds = time.monotonic() - start_time
+    nodes = 0
 
     # Candidate serving sizes per item (in "menu servings").
     serving_sizes = np.arange(0.5, 3.5, 0.5)  # 0.5, 1.0, ..., 3.0
-    n_sizes = len(serving_sizes)
 
-    food_items = []      # Items that pass validation.
-    macro_rows = {       # Rows for the macro matrix A.
-        "calories": [],
-        "g_protein": [],
-        "g_carbs": [],
-        "g_fat": [],
+    # Global bound on the number of chosen items.
+    max_items = 15
+
+    # Presolve: shrink the candidate set. The exact model is built on the full
+    # menu, with dropped items masked out, so it can be reused for any goal.
+    A_menu = A
+    phase_start = time.monotonic()
+    keep, presolve_stats = presolve_menu(A, g, serving_sizes)
+    A = A[:, keep]
+    n_items = len(keep)
+    build_seconds += time.monotonic() - phase_start
+
+    deadline = None if deadline_ms is None else start_time + deadline_ms / 1000.0
+
+    def objective_of(x):
+        r = A @ x - g
+        return float(r @ r)
+
+    # Anytime incumbent: a polished rounding of the relaxation, available
+    # long before the exact model is even built. With nothing kept (a goal
+    # already met, or every item excluded) the empty plan is the only one.
+    if n_items == 0:
+        x_values, lower_bound = np.zeros(0), float(g @ g)
+        status = "optimal"
+    else:
+        x_values, lower_bound = _heuristic_plan(A, g, serving_sizes, max_items)
+        status = "deadline"
+
+    remaining = None if deadline is None else deadline - time.monotonic()
+    if n_items > 0 and (remaining is None or remaining > 0):
+        # Compile (or fetch) the menu's model here so the forked child
+        # inherits it and repeat solves in this process skip canonicalization.
+        # A spawned child could not use it, so skip the work there.
+        if FORK_AVAILABLE:
+            phase_start = time.monotonic()
+            try:
+                exact_model(A_menu, serving_sizes, max_items, formulation)
+            except Exception:
+                pass
+            build_seconds += time.monotonic() - phase_start
+            remaining = None if deadline is None else deadline - time.monotonic()
+
+        # Run ECOS_BB in a child process so it can be abandoned at the deadline.
+        recv_conn, send_conn = _exact_context.Pipe(duplex=False)
+        worker = _exact_context.Process(
+            target=_solve_exact,
+            args=(A_menu, g, keep, serving_sizes, max_items, formulation, send_conn),
+            daemon=True,
+        )
+        worker.start()
+        send_conn.close()
+
+        if recv_conn.poll(remaining):
+            try:
+                exact, nodes = recv_conn.recv()
+            except EOFError:
+                exact = None
+            worker.join()
+            if exact is not None:
+                exact = exact[keep]
+
+            if exact is not None:
+                # ECOS_BB finished: its objective is the proven optimum.
+                exact_objective = objective_of(exact)
+                if exact_objective <= objective_of(x_values):
+                    x_values = exact
+                lower_bound = max(lower_bound, min(exact_objective, objective_of(x_values)))
+                status = "optimal"
+            else:
+                status = "heuristic"
+        else:
+            worker.terminate()
+            worker.join()
+
+    # The bounds above only cover the kept items. When presolve dropped any,
+    # bound the whole menu's relaxation instead.
+    if n_items < A_menu.shape[1]:
+        _, lower_bound = _relaxation_bound(A_menu, g, serving_sizes[-1])
+        if status == "optimal":
+            status = "presolved"
+
+    objective_value = objective_of(x_values)
+    total_seconds = time.monotonic() - start_time
+    servings = np.zeros(A_menu.shape[1])
+    servings[keep] = x_values
+    return {
+        "servings": servings,
+        "status": status,
+        "objective": objective_value,
+        "lower_bound": lower_bound,
+        "gap": max(objective_value - lower_bound, 0.0),
+        "presolve": presolve_stats,
+        "build_ms": 1000.0 * build_seconds,
+        "solve_ms": 1000.0 * max(total_seconds - build_seconds, 0.0),
+        "nodes": int(nodes or 0),
     }
+
+
+def solve_meal_plan(menu, target, verbose: bool = True, deadline_ms=None,
+                    formulation=DEFAULT_FORMULATION):
+    """
+    Solve a simple meal-planning optimization problem for the given menu and macro targets.
+
+    menu        – list of items with 'nutrition' and 'serving_size' fields
+    target      – dict keyed by a prefix of NUTRIENT_KEYS: calories, g_protein,
+                  g_carbs, g_fat, and optionally g_fiber, g_sugar, mg_sodium
+    deadline_ms – optional wall-clock budget; when it passes, the best plan found
+                  so far is returned together with its optimality gap
+    formulation – exact model to use, one of FORMULATIONS
+    """
+    start_time = time.monotonic()
+
+    # Planned nutrients and their planning-unit scales.
+    keys = NUTRIENT_KEYS[:REQUIRED_NUTRIENTS]
+    for key in NUTRIENT_KEYS[REQUIRED_NUTRIENTS:]:
+        if key not in target:
+            break
+        keys.append(key)
+    scale = np.array([PLAN_SCALE.get(key, 1.0) for key in keys])
+
+    # Desired nutrient vector (goal), in planning units.
+    g = scale * np.array([target[key] for key in keys], dtype=float)
+
+    food_items = []      # Items that pass validation.
+    columns = []         # Columns of the nutrient matrix A.
     item_id_map = []     # Optional mapping back to original IDs.
 
-    # Filter to items with numeric macro entries and build macro rows.
+    # Filter to items with numeric macro entries and build nutrient columns.
     for item in menu:
         try:
             n = item["nutrition"]
-            row = [n["calories"], n["g_protein"], n["g_carbs"], n["g_fat"]]
+            column = [n.get(key) for key in keys]
             # Skip items with missing or non-numeric macros.
-            if all(isinstance(x, (int, float)) for x in row):
-                food_items.append(item)
-                item_id_map.append(item["id"])
-                for key, val in zip(macro_rows.keys(), row):
-                    macro_rows[key].append(val)
+            if not all(isinstance(x, (int, float)) for x in column[:REQUIRED_NUTRIENTS]):
+                continue
+            column = [x if isinstance(x, (int, float)) else 0.0 for x in column]
+            food_items.append(item)
+            item_id_map.append(item["id"])
+            columns.append(column)
         except Exception:
             # If anything goes wrong, quietly skip that item.
             continue
 
     n_items = len(food_items)
 
-    # Macro matrix: 4 × n_items (rows: calories, protein, carbs, fat).
-    A = np.array([
-        macro_rows["calories"],
-        macro_rows["g_protein"],
-        macro_rows["g_carbs"],
-        macro_rows["g_fat"]
-    ])
-
-    # Binary decision variables b[i][k] = 1 if item i is taken at serving_sizes[k].
-    b = [
-        [cp.Variable(boolean=True) for _ in range(n_sizes)]
-        for _ in range(n_items)
-    ]
-
-    # x_i = total "servings" for item i (weighted sum over size choices).
-    x_vars = [
-        cp.sum([b[i][k] * serving_sizes[k] for k in range(n_sizes)])
-        for i in range(n_items)
-    ]
-
-    # Total macros for chosen servings: A * x.
-    total_macros = A @ cp.hstack(x_vars)
-
-    # Objective: minimize squared error between actual macros and target macros.
-    objective = cp.Minimize(cp.sum_squares(total_macros - g))
-
-    constraints = []
+    # Nutrient matrix in planning units: len(keys) × n_items.
+    A = scale[:, None] * np.array(columns, dtype=float).reshape(n_items, len(keys)).T
 
-    # At most one serving-size option per item (or none).
-    for i in range(n_items):
-        constraints.append(cp.sum(b[i]) <= 1)
-
-    # Optional global bound: limit the total number of chosen servings.
-    max_items = 15
-    constraints.append(
-        cp.sum([b[i][k] for i in range(n_items) for k in range(n_sizes)]) <= max_items
-    )
-
-    # Mixed-integer convex problem: use ECOS_BB which wraps ECOS + branch-and-bound.
-    problem = cp.Problem(objective, constraints)
-    problem.solve(solver=cp.ECOS_BB, verbose=False)
+    solved = solve_matrix(A, g, deadline_ms, formulation, start_time)
+    x_values = solved["servings"]
+    presolve_stats = solved["presolve"]
 
     result = []
-    x_values = np.array([x.value for x in x_vars])
 
     # Convert non-trivial serving amounts into the output structure.
     for i, val in enumerate(x_values):
@@ -102,9 +529,10 @@ def solve_meal_plan(menu, target, verbose: bool = True):
             entry["servings"] = round(val, 2)
             result.append(entry)
 
-    # Compute actual macro totals for the solution.
-    actual_macros = A @ x_values
-    macro_labels = ["Calories", "Protein (g)", "Carbs (g)", "Fat (g)"]
+    # Compute actual nutrient totals for the solution, in natural units.
+    actual_macros = (A @ x_values) / scale
+    goal_values = g / scale
+    macro_labels = NUTRIENT_LABELS[:len(keys)]
 
     if verbose:
         # Show chosen items, servings, and human-readable serving sizes.
@@ -123,44 +551,40 @@ def solve_meal_plan(menu, target, verbose: bool = True):
         ])
         print(df)
 
+        print(
+            f"\nPresolve: {presolve_stats['items_before']} -> {presolve_stats['items_after']} items "
+            f"({presolve_stats['over_budget']} over budget, {presolve_stats['merged']} merged, "
+            f"{presolve_stats['dominated']} dominated)"
+        )
+        print(
+            f"Status: {solved['status']}, build {solved['build_ms']:.1f} ms, "
+            f"solve {solved['solve_ms']:.1f} ms, {solved['nodes']} nodes"
+        )
+
         # Print macro totals vs goal with errors.
         print("\n--- Macro Results ---")
-        for label, actual, goal_val in zip(macro_labels, actual_macros, g):
+        for label, actual, goal_val in zip(macro_labels, actual_macros, goal_values):
             diff = actual - goal_val
             print(f"{label:<15}: {actual:.2f} (error: {diff:+.2f})")
 
     # Structured dictionary result: goal, actual totals, and chosen meal.
     return {
         "goal": target,
-        "totals": {
-            "calories": round(actual_macros[0], 2),
-            "g_protein": round(actual_macros[1], 2),
-            "g_carbs": round(actual_macros[2], 2),
-            "g_fat": round(actual_macros[3], 2),
-        },
+        "totals": {key: round(actual, 2) for key, actual in zip(keys, actual_macros)},
         "meal": result,
+        "status": solved["status"],
+        "objective": round(solved["objective"], 4),
+        "lower_bound": round(solved["lower_bound"], 4),
+        "gap": round(solved["gap"], 4),
+        "presolve": presolve_stats,
+        "build_ms": round(solved["build_ms"], 3),
+        "solve_ms": round(solved["solve_ms"], 3),
+        "nodes": solved["nodes"],
     }
 
 
-if __name__ == "__main__":
-    # CLI entry: read a simplified menu, run the solver, and print name/servings pairs.
-    if len(sys.argv) != 6:
-        print("Usage: python solver.py <simplified_menu_path> <calories> <g_protein> <g_carbs> <g_fat>")
-        sys.exit(1)
-
-    menu_path = sys.argv[1]
-
-    # Parse numeric macro targets from the command line.
-    try:
-        calories = float(sys.argv[2])
-        g_protein = float(sys.argv[3])
-        g_carbs = float(sys.argv[4])
-        g_fat = float(sys.argv[5])
-    except ValueError:
-        print("Error: target macros must be numeric.")
-        sys.exit(1)
-
-    # Load simplified menu structure (dict of stations or flat list).
+def load_menu_items(menu_path):
+    """Load a simplified menu (dict of stations or flat list) as one list of items."""
     with open(menu_path, "r") as f:
         data = json.load(f)
 
@@ -170,27 +594,92 @@ if __name__ == "__main__":
         for station, items in data.items():
             if isinstance(items, list):
                 menu_items.extend(items)
-    elif isinstance(data, list):
+        return menu_items
+    if isinstance(data, list):
         # Already a plain list of items.
-        menu_items = data
-    else:
-        print("Error: unsupported menu JSON structure")
-        sys.exit(1)
+        return data
+    raise ValueError("unsupported menu JSON structure")
 
-    # Build target macro dictionary in the format solve_meal_plan expects.
-    target = {
-        "calories": calories,
-        "g_protein": g_protein,
-        "g_carbs": g_carbs,
-        "g_fat": g_fat,
-    }
 
-    # Solve the optimization problem without printing intermediate tables.
-    result = solve_meal_plan(menu_items, target, verbose=False)
-
-    # C++ side expects tab-separated lines: "<name>\t<servings>".
+def result_lines(result):
+    """
+    Format a solve for the C++ side: tab-separated "<name>\t<servings>" lines,
+    then trailer lines starting with '#' that carry how the solve finished.
+    """
+    lines = []
     for entry in result.get("meal", []):
         name = entry.get("name", "")
         servings = entry.get("servings", 0.0)
         if name and servings:
-            print(f"{name}\t{servings}")
+            lines.append(f"{name}\t{servings}")
+
+    lines.append(f"#status\t{result['status']}")
+    lines.append(f"#objective\t{result['objective']}")
+    lines.append(f"#gap\t{result['gap']}")
+    lines.append(f"#items_before\t{result['presolve']['items_before']}")
+    lines.append(f"#items_after\t{result['presolve']['items_after']}")
+    lines.append(f"#build_ms\t{result['build_ms']}")
+    lines.append(f"#solve_ms\t{result['solve_ms']}")
+    lines.append(f"#nodes\t{result['nodes']}")
+    return lines
+
+
+if __name__ == "__main__":
+    # CLI entry: read a simplified menu, run the solver, and print name/servings pairs.
+    args = sys.argv[1:]
+    deadline_ms = DEFAULT_DEADLINE_MS
+    formulation = DEFAULT_FORMULATION
+    excluded_names = set()
+
+    # Trailing "--name value" options, in any order.
+    while len(args) >= 2 and args[-2].startswith("--"):
+        option, value = args[-2], args[-1]
+        args = args[:-2]
+        if option == "--deadline-ms":
+            try:
+                deadline_ms = float(value)
+            except ValueError:
+                print("Error: deadline must be numeric.")
+                sys.exit(1)
+        elif option == "--formulation" and value in FORMULATIONS:
+            formulation = value
+        elif option == "--exclude":
+            # One item name per line, for items a diet filter rules out.
+            try:
+                with open(value, "r") as f:
+                    excluded_names = {line.rstrip("\n") for line in f if line.strip()}
+            except OSError as e:
+                print(f"Error: {e}")
+                sys.exit(1)
+        else:
+            print(f"Error: bad option {option} {value}")
+            sys.exit(1)
+
+    if not 1 + REQUIRED_NUTRIENTS <= len(args) <= 1 + len(NUTRIENT_KEYS):
+        print("Usage: python solver.py <simplified_menu_path> <calories> <g_protein> <g_carbs> <g_fat>"
+              " [<g_fiber> [<g_sugar> [<mg_sodium>]]] [--deadline-ms N] [--formulation onehot|integer]"
+              " [--exclude names_file]")
+        sys.exit(1)
+
+    menu_path = args[0]
+
+    # Parse numeric nutrient targets from the command line, in NUTRIENT_KEYS order.
+    try:
+        target = {key: float(value) for key, value in zip(NUTRIENT_KEYS, args[1:])}
+    except ValueError:
+        print("Error: target nutrients must be numeric.")
+        sys.exit(1)
+
+    try:
+        menu_items = load_menu_items(menu_path)
+    except ValueError as e:
+        print(f"Error: {e}")
+        sys.exit(1)
+    menu_items = [item for item in menu_items if item.get("name") not in excluded_names]
+
+    # Solve the optimization problem without printing intermediate tables.
+    result = solve_meal_plan(menu_items, target, verbose=False, deadline_ms=deadline_ms,
+                             formulation=formulation)
+
+    for line in result_lines(result):
+        print(line)
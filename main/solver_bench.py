@@ -0,0 +1,63 @@
+"""
+Benchmark for the exact models in solver.py: builds and solves the one-hot and
+integer formulations on synthetic menus of several sizes, and reports build time,
+solve time, and branch-and-bound nodes, and checks that both reach the same
+objective.
+
+Usage: python solver_bench.py [menu sizes...]   (default: 10 20 30)
+"""
+import sys
+import time
+
+import cvxpy as cp
+import numpy as np
+
+from solver import FORMULATIONS, branch_nodes, build_exact_model
+
+
+def make_menu(n, rng):
+    """Nutrient matrix (4 × n) whose calories follow from the macros, like real items."""
+    protein = rng.uniform(0, 30, n)
+    carbs = rng.uniform(0, 60, n)
+    fat = rng.uniform(0, 25, n)
+    return np.vstack([4 * protein + 4 * carbs + 9 * fat, protein, carbs, fat])
+
+
+def run(A, g, formulation):
+    """Returns build seconds, solve seconds, nodes, and objective for one formulation."""
+    serving_sizes = np.arange(0.5, 3.5, 0.5)
+
+    start = time.perf_counter()
+    problem, x, goal, allowed = build_exact_model(A, serving_sizes, 15, formulation)
+    goal.value = g
+    allowed.value = np.ones(A.shape[1])
+    problem.get_problem_data(cp.ECOS_BB)
+    built = time.perf_counter()
+
+    problem.solve(solver=cp.ECOS_BB, verbose=False)
+    solved = time.perf_counter()
+
+    r = A @ np.asarray(x.value, dtype=float) - g
+    return built - start, solved - built, branch_nodes(problem), float(r @ r)
+
+
+def main():
+    sizes = [int(arg) for arg in sys.argv[1:]] or [10, 20, 30]
+    rng = np.random.default_rng(42)
+    g = np.array([700.0, 50.0, 90.0, 20.0])
+
+    print(f"{'items':>6} {'model':>8} {'build ms':>10} {'solve ms':>10} {'nodes':>8} {'objective':>12}")
+    for n in sizes:
+        A = make_menu(n, rng)
+        objectives = []
+        for formulation in FORMULATIONS:
+            build_s, solve_s, nodes, objective = run(A, g, formulation)
+            objectives.append(objective)
+            print(f"{n:>6} {formulation:>8} {1000 * build_s:>10.1f} {1000 * solve_s:>10.1f} "
+                  f"{nodes:>8} {objective:>12.4f}")
+        if max(objectives) - min(objectives) > 1e-4 * max(1.0, min(objectives)):
+            print(f"{'':>6} warning: formulations disagree on {n} items")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,93 @@
+"""
+Long-lived solver process for meal_tracker. It reads length-prefixed binary
+requests on stdin and answers on stdout, so the interpreter, numpy, and cvxpy
+load once per session, compiled models stay cached between meals, and nothing
+is written to disk. Menus are simplified natively by MenuManager.
+
+Every message is a frame: a little-endian u32 payload length, then the payload.
+Integers are little-endian u32 and reals little-endian f64.
+
+Requests start with a u8 opcode (opcode 1 is reserved):
+    2 SOLVE     u32 items n, u32 nutrients m, f64 deadline ms,
+                u8 formulation (0 onehot, 1 integer),
+                f64 goal[m], f64 matrix[n * m] (item by item, planning units)
+
+Replies start with a u8: 0 for success, 1 for an error followed by a UTF-8
+message. Successful replies carry:
+    SOLVE       u8 status (0 optimal, 1 heuristic, 2 deadline, 3 optimal over
+                the presolved items only), f64 objective,
+                f64 gap, u32 items before presolve, u32 items after,
+                f64 build ms, f64 solve ms, u32 branch-and-bound nodes,
+                u32 k, then k pairs of (u32 item index, f64 servings)
+"""
+import struct
+import sys
+
+import numpy as np
+
+from solver import FORMULATIONS, solve_matrix
+
+OP_SOLVE = 2
+STATUS_CODES = {"optimal": 0, "heuristic": 1, "deadline": 2, "presolved": 3}
+
+
+def solve(payload):
+    """Solve one meal from its nutrient matrix and goal."""
+    n, m, deadline_ms, formulation = struct.unpack_from("<IIdB", payload)
+    offset = struct.calcsize("<IIdB")
+    g = np.frombuffer(payload, dtype="<f8", count=m, offset=offset)
+    matrix = np.frombuffer(payload, dtype="<f8", count=n * m, offset=offset + 8 * m)
+    A = matrix.reshape(n, m).T.astype(float)
+
+    solved = solve_matrix(A, g.astype(float), deadline_ms, FORMULATIONS[formulation])
+    picks = [(j, round(float(v), 2)) for j, v in enumerate(solved["servings"]) if v > 0.01]
+
+    reply = struct.pack("<BddII", STATUS_CODES[solved["status"]], solved["objective"],
+                        solved["gap"], solved["presolve"]["items_before"],
+                        solved["presolve"]["items_after"])
+    reply += struct.pack("<ddII", solved["build_ms"], solved["solve_ms"], solved["nodes"],
+                         len(picks))
+    for j, servings in picks:
+        reply += struct.pack("<Id", j, servings)
+    return reply
+
+
+def read_exact(stream, size):
+    """Read exactly size bytes, or return None at end of input."""
+    data = b""
+    while len(data) < size:
+        chunk = stream.read(size - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def main():
+    requests = sys.stdin.buffer
+    replies = sys.stdout.buffer
+    # Anything the solver prints must not corrupt the replies.
+    sys.stdout = sys.stderr
+
+    while True:
+        header = read_exact(requests, 4)
+        if header is None:
+            return
+        payload = read_exact(requests, struct.unpack("<I", header)[0])
+        if not payload:
+            return
+
+        try:
+            if payload[0] == OP_SOLVE:
+                reply = b"\x00" + solve(payload[1:])
+            else:
+                raise ValueError(f"unknown opcode {payload[0]}")
+        except Exception as e:
+            reply = b"\x01" + str(e).encode("utf-8")
+
+        replies.write(struct.pack("<I", len(reply)) + reply)
+        replies.flush()
+
+
+if __name__ == "__main__":
+    main()